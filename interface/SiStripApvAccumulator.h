@@ -0,0 +1,67 @@
+#ifndef SiStripMonitorTrack_SiStripApvAccumulator_h
+#define SiStripMonitorTrack_SiStripApvAccumulator_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripApvAccumulator
+//
+/**\class SiStripApvAccumulator SiStripApvAccumulator.h DQM/SiStripMonitorTrack/interface/SiStripApvAccumulator.h
+
+ Description: per-APV on-track cluster counts, corrected charge and StoN sums
+
+ Implementation:
+     One flat array over all the APVs of the active modules (nApvPairs*2 per
+     module from SiStripDetCabling), the APVs of a module being contiguous
+     from its offset. A cluster goes to the APV of its barycenter (128 strips
+     per APV), so filling is an offset lookup and three additions. The means
+     are written to a single 2D ME: modules (dense index, labelled with their
+     detid) on x, entries / mean charge / mean StoN of each APV on y.
+*/
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+class MonitorElement;
+class DQMStore;
+
+class SiStripApvAccumulator {
+public:
+  enum Statistic { Entries = 0, ChargeCorr, StoNCorr, nStatistics };
+  static const uint16_t maxApvs = 6;
+  static const uint16_t stripsPerApv = 128;
+
+  SiStripApvAccumulator() {}
+
+  // detids and their number of APVs, the index of a module is its position in detids
+  void setModules(const std::vector<uint32_t>& detids, const std::vector<uint16_t>& napvs);
+  void reset();
+  inline uint32_t nApvs() const { return n_.size(); }
+
+  inline void fill(uint32_t index, float barycenter, float chargeCorr, float stonCorr, bool validStoN) {
+    uint32_t apv = uint32_t(barycenter)/stripsPerApv;
+    if (apv >= napvs_[index]) apv = napvs_[index] - 1;
+    uint32_t k = offsets_[index] + apv;
+    ++n_[k];
+    sumCharge_[k] += chargeCorr;
+    if (validStoN) {
+      ++nStoN_[k];
+      sumStoN_[k] += stonCorr;
+    }
+  }
+
+  MonitorElement* book(DQMStore* dbe, const std::string& name) const;
+  void fill(MonitorElement* me) const;
+
+private:
+  std::vector<uint32_t> detIds_;
+  std::vector<uint32_t> offsets_;   // first APV of each module
+  std::vector<uint16_t> napvs_;
+
+  std::vector<uint32_t> n_;
+  std::vector<uint32_t> nStoN_;
+  std::vector<double>   sumCharge_;
+  std::vector<double>   sumStoN_;
+};
+#endif
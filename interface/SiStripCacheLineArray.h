@@ -0,0 +1,53 @@
+#ifndef SiStripMonitorTrack_SiStripCacheLineArray_h
+#define SiStripMonitorTrack_SiStripCacheLineArray_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripCacheLineArray
+//
+/**\class SiStripCacheLineArray SiStripCacheLineArray.h DQM/SiStripMonitorTrack/interface/SiStripCacheLineArray.h
+
+ Description: fixed array of plain structs starting on a cache line boundary
+
+ Implementation:
+     std::allocator does not honour alignments above that of the fundamental
+     types, so the storage is a byte vector with one line of slack and the
+     first element is placed on the first line boundary in it. With T
+     declared alignas(lineSize), every element starts its own line. assign()
+     value-initialises the elements and invalidates the previous ones; T must
+     be trivially destructible.
+*/
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <stdint.h>
+
+template <class T>
+class SiStripCacheLineArray {
+public:
+  static const size_t lineSize = 64;
+
+  SiStripCacheLineArray() : elements_(0), size_(0) {}
+
+  void assign(size_t n) {
+    storage_.assign(n*sizeof(T) + lineSize, 0);
+    elements_ = reinterpret_cast<T*>((uintptr_t(&storage_[0]) + lineSize - 1) & ~uintptr_t(lineSize - 1));
+    size_ = n;
+    for (size_t i = 0; i < n; ++i) new (elements_ + i) T();
+  }
+
+  inline T&       operator[](size_t i)       { return elements_[i]; }
+  inline const T& operator[](size_t i) const { return elements_[i]; }
+  inline size_t size() const { return size_; }
+
+private:
+  SiStripCacheLineArray(const SiStripCacheLineArray&);
+  SiStripCacheLineArray& operator=(const SiStripCacheLineArray&);
+
+  std::vector<char> storage_;
+  T*     elements_;
+  size_t size_;
+};
+#endif
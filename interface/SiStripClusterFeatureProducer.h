@@ -0,0 +1,36 @@
+#ifndef SiStripMonitorTrack_SiStripClusterFeatureProducer_h
+#define SiStripMonitorTrack_SiStripClusterFeatureProducer_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripClusterFeatureProducer
+//
+/**\class SiStripClusterFeatureProducer SiStripClusterFeatureProducer.h DQM/SiStripMonitorTrack/interface/SiStripClusterFeatureProducer.h
+
+ Description: computes the SiStripClusterFeatures table once per event
+
+ Implementation:
+     Walks the cluster collection once, gets noise and StoN from
+     SiStripClusterInfo and the global position from the geometry. Several
+     SiStripMonitorTrack / SiStripMonitorMuonHLT instances can then read the
+     table (ClusterFeatures / clusterFeaturesTag) instead of recomputing.
+*/
+
+#include "FWCore/Framework/interface/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+
+class SiStripClusterFeatureProducer : public edm::EDProducer {
+public:
+  explicit SiStripClusterFeatureProducer(const edm::ParameterSet&);
+  ~SiStripClusterFeatureProducer();
+
+private:
+  virtual void produce(edm::Event&, const edm::EventSetup&);
+
+  edm::InputTag Cluster_src_;
+};
+#endif
@@ -0,0 +1,58 @@
+#ifndef SiStripMonitorTrack_SiStripClusterFeatures_h
+#define SiStripMonitorTrack_SiStripClusterFeatures_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripClusterFeatures
+//
+/**\class SiStripClusterFeatures SiStripClusterFeatures.h DQM/SiStripMonitorTrack/interface/SiStripClusterFeatures.h
+
+ Description: per-event table of the strip cluster quantities used by the monitors
+
+ Implementation:
+     Structure of arrays, one row per cluster in the order of the data of the
+     edmNew::DetSetVector<SiStripCluster> it was made from: the row of a cluster
+     is the key of its ClusterRef (or its offset in data()). The DetSets are
+     described by detIds/detOffsets, rows detOffsets[i]..detOffsets[i+1]-1
+     belong to detIds[i]. Filled once per event by SiStripClusterFeatureProducer.
+*/
+
+#include <vector>
+#include <stdint.h>
+
+#include "DataFormats/Provenance/interface/ProductID.h"
+
+class SiStripClusterFeatures {
+public:
+  SiStripClusterFeatures() {}
+
+  inline unsigned int size() const { return StoN.size(); }
+  inline unsigned int nDets() const { return detIds.size(); }
+  inline uint32_t detId(unsigned int row) const { return detIds[detIndex[row]]; }
+
+  void reserve(unsigned int ndets, unsigned int nclusters) {
+    detIds.reserve(ndets); detOffsets.reserve(ndets+1);
+    detIndex.reserve(nclusters); StoN.reserve(nclusters); noise.reserve(nclusters);
+    charge.reserve(nclusters); width.reserve(nclusters); barycenter.reserve(nclusters);
+    eta.reserve(nclusters); phi.reserve(nclusters);
+  }
+
+  // cluster collection the rows refer to
+  edm::ProductID clusterProductID;
+
+  // per DetSet
+  std::vector<uint32_t> detIds;
+  std::vector<uint32_t> detOffsets;   // nDets()+1 entries
+
+  // per cluster
+  std::vector<uint32_t> detIndex;     // index in detIds
+  std::vector<float>    StoN;
+  std::vector<float>    noise;        // rescaled by gain
+  std::vector<uint16_t> charge;
+  std::vector<uint16_t> width;
+  std::vector<float>    barycenter;   // in strips
+  std::vector<float>    eta;
+  std::vector<float>    phi;
+};
+#endif
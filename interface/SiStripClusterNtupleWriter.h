@@ -0,0 +1,68 @@
+#ifndef SiStripMonitorTrack_SiStripClusterNtupleWriter_h
+#define SiStripMonitorTrack_SiStripClusterNtupleWriter_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripClusterNtupleWriter
+//
+/**\class SiStripClusterNtupleWriter SiStripClusterNtupleWriter.h DQM/SiStripMonitorTrack/interface/SiStripClusterNtupleWriter.h
+
+ Description: optional columnar output of the per-cluster quantities computed by SiStripMonitorTrack
+
+ Implementation:
+     One flat TTree with one branch per quantity (split, compressed baskets).
+     Entries are buffered in the baskets and streamed to disk every
+     "AutoFlush" clusters, so memory stays bounded whatever the job length.
+     The histograms of the module can be rebuilt offline from the file with
+     test/rebuildHistogramsFromClusterNtuple.py, with any binning; the
+     records carry the weight of the corresponding histogram fills.
+*/
+
+#include <string>
+#include <stdint.h>
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+class TFile;
+class TTree;
+
+class SiStripClusterNtupleWriter {
+public:
+  struct Record {
+    uint32_t detid;
+    uint8_t  flag;       // 0 = OffTrack, 1 = OnTrack
+    float    StoN;
+    float    cosRZ;      // -2 for off-track clusters
+    uint16_t charge;
+    uint16_t width;
+    float    barycenter;
+    float    noise;
+    uint32_t run;
+    uint32_t lumi;
+    uint32_t event;
+    float    weight;     // weight of the fills of the module: 1/fraction for sampled off-track clusters
+  };
+
+  explicit SiStripClusterNtupleWriter(const edm::ParameterSet&);
+  ~SiStripClusterNtupleWriter();
+
+  void open();
+  void close();
+  inline bool isOpen() const { return tree_ != 0; }
+  inline void fill(const Record& record) { record_ = record; fillTree(); }
+
+private:
+  void fillTree();
+
+  std::string fileName_;
+  std::string treeName_;
+  int compressionLevel_;
+  int basketSize_;
+  long long autoFlush_;
+
+  TFile* file_;
+  TTree* tree_;
+  Record record_;
+};
+#endif
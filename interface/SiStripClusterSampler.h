@@ -0,0 +1,62 @@
+#ifndef SiStripMonitorTrack_SiStripClusterSampler_h
+#define SiStripMonitorTrack_SiStripClusterSampler_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripClusterSampler
+//
+/**\class SiStripClusterSampler SiStripClusterSampler.h DQM/SiStripMonitorTrack/interface/SiStripClusterSampler.h
+
+ Description: deterministic per-event sample of the off-track clusters
+
+ Implementation:
+     With n candidate clusters in the event and a budget of MaxClusters, each
+     cluster is kept with probability fraction = min(1, MaxClusters/n) and its
+     fills get the weight 1/fraction, so the weighted distributions estimate
+     the unsampled ones. The decision of a cluster is a hash of the seed, the
+     run and event numbers and the position of the cluster in the collection:
+     the same job on the same input gives the same sample, and another Seed
+     gives an independent one.
+*/
+
+#include <stdint.h>
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+class SiStripClusterSampler {
+public:
+  explicit SiStripClusterSampler(const edm::ParameterSet&);
+
+  inline bool on() const { return on_; }
+  // returns the sampling fraction of the event (1 if the candidates are within the budget)
+  double beginEvent(uint32_t run, uint32_t event, uint32_t ncandidates);
+  inline bool   sampling() const { return fraction_ < 1.; }
+  inline double fraction() const { return fraction_; }
+  inline float  weight() const { return weight_; }
+
+  // cluster at position index of the collection kept in the sample
+  inline bool selected(uint32_t index) const {
+    if (fraction_ >= 1.) return true;
+    return mix(eventKey_ + index) < threshold_;
+  }
+
+private:
+  // splitmix64 finaliser
+  static inline uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  bool     on_;
+  uint32_t maxClusters_;
+  uint64_t seed_;
+
+  double   fraction_;
+  float    weight_;
+  uint64_t eventKey_;
+  uint64_t threshold_;
+};
+#endif
@@ -0,0 +1,70 @@
+#ifndef SiStripMonitorTrack_SiStripConditionsContext_h
+#define SiStripMonitorTrack_SiStripConditionsContext_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripConditionsContext
+//
+/**\class SiStripConditionsContext SiStripConditionsContext.h DQM/SiStripMonitorTrack/interface/SiStripConditionsContext.h
+
+ Description: EventSetup products of the monitors, resolved once per IOV
+
+ Implementation:
+     update() is called at beginRun and at the start of every event. An
+     ESWatcher per record compares the cache identifier of the record and the
+     product is fetched again only when it changed, so the event path reads
+     plain pointers instead of doing an EventSetup lookup per event or per
+     hit. The context is passed by const reference down the event path; only
+     the products requested in the constructor are fetched.
+*/
+
+#include <stdint.h>
+
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/Framework/interface/ESHandle.h"
+#include "FWCore/Framework/interface/ESWatcher.h"
+#include "Geometry/Records/interface/IdealGeometryRecord.h"
+#include "Geometry/Records/interface/TrackerDigiGeometryRecord.h"
+#include "CalibTracker/Records/interface/SiStripDetCablingRcd.h"
+#include "MagneticField/Records/interface/IdealMagneticFieldRecord.h"
+
+class TrackerTopology;
+class TrackerGeometry;
+class SiStripDetCabling;
+class MagneticField;
+
+class SiStripConditionsContext {
+public:
+  enum Product { Topology = 0x1, Geometry = 0x2, Cabling = 0x4, Field = 0x8 };
+
+  // products: or of Product
+  explicit SiStripConditionsContext(unsigned int products);
+
+  // fetch the products whose record changed since the last call, returns their Product bits
+  unsigned int update(const edm::EventSetup& es);
+  // the field is needed only by some configurations, known at beginRun
+  inline void require(unsigned int products) { products_ |= products; }
+
+  inline const TrackerTopology*   topology() const { return topology_; }
+  inline const TrackerGeometry*   geometry() const { return geometry_; }
+  inline const SiStripDetCabling* cabling() const { return cabling_; }
+  inline const MagneticField*     field() const { return field_; }
+  // number of product fetches since the construction
+  inline uint32_t nFetches() const { return nFetches_; }
+
+private:
+  unsigned int products_;
+
+  edm::ESWatcher<IdealGeometryRecord>       topologyWatcher_;
+  edm::ESWatcher<TrackerDigiGeometryRecord> geometryWatcher_;
+  edm::ESWatcher<SiStripDetCablingRcd>      cablingWatcher_;
+  edm::ESWatcher<IdealMagneticFieldRecord>  fieldWatcher_;
+
+  const TrackerTopology*   topology_;
+  const TrackerGeometry*   geometry_;
+  const SiStripDetCabling* cabling_;
+  const MagneticField*     field_;
+  uint32_t nFetches_;
+};
+#endif
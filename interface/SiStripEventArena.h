@@ -0,0 +1,89 @@
+#ifndef SiStripMonitorTrack_SiStripEventArena_h
+#define SiStripMonitorTrack_SiStripEventArena_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripEventArena
+//
+/**\class SiStripEventArena SiStripEventArena.h DQM/SiStripMonitorTrack/interface/SiStripEventArena.h
+
+ Description: monotonic allocator for the per-event scratch data of the monitors
+
+ Implementation:
+     allocate() moves a pointer through a chunk and never frees; reset() at
+     the end of the event makes the whole chunk available again. When an
+     event needs more than the chunk, extra chunks are taken from the heap and
+     reset() replaces them all by one chunk of the peak size, so after the
+     first large events the arena does no heap allocation. Containers use it
+     through SiStripArenaAllocator (deallocate is a no-op) and must release
+     their storage before reset(). With EDM_ML_DEBUG the heap allocations are
+     counted.
+*/
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+class SiStripEventArena {
+public:
+  explicit SiStripEventArena(size_t chunkSize = 1 << 20);
+  ~SiStripEventArena();
+
+  inline void* allocate(size_t bytes, size_t align) {
+    size_t offset = (used_ + align - 1) & ~(align - 1);
+    if (offset + bytes > size_) return allocateChunk(bytes, align);
+    used_ = offset + bytes;
+    return current_ + offset;
+  }
+  template <class T> inline T* allocate(size_t n) { return static_cast<T*>(allocate(n*sizeof(T), alignof(T))); }
+
+  // everything allocated so far is released
+  void reset();
+
+  // bytes in use, in all the chunks
+  inline size_t used() const { return spilled_ + used_; }
+#ifdef EDM_ML_DEBUG
+  // chunks taken from the heap since the construction
+  inline uint64_t heapAllocations() const { return heapAllocations_; }
+#endif
+
+private:
+  SiStripEventArena(const SiStripEventArena&);
+  SiStripEventArena& operator=(const SiStripEventArena&);
+  void* allocateChunk(size_t bytes, size_t align);
+
+  char*  current_;
+  size_t size_;
+  size_t used_;
+  size_t spilled_;               // bytes used in the full chunks
+  std::vector<char*> full_;      // chunks of the event before current_
+#ifdef EDM_ML_DEBUG
+  uint64_t heapAllocations_;
+#endif
+};
+
+// STL allocator on a SiStripEventArena
+template <class T>
+class SiStripArenaAllocator {
+public:
+  typedef T value_type;
+
+  explicit SiStripArenaAllocator(SiStripEventArena& arena) : arena_(&arena) {}
+  template <class U> SiStripArenaAllocator(const SiStripArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  inline T* allocate(size_t n) { return arena_->allocate<T>(n); }
+  inline void deallocate(T*, size_t) {}
+  inline SiStripEventArena* arena() const { return arena_; }
+
+  template <class U> struct rebind { typedef SiStripArenaAllocator<U> other; };
+
+private:
+  SiStripEventArena* arena_;
+};
+
+template <class T, class U>
+inline bool operator==(const SiStripArenaAllocator<T>& a, const SiStripArenaAllocator<U>& b) { return a.arena() == b.arena(); }
+template <class T, class U>
+inline bool operator!=(const SiStripArenaAllocator<T>& a, const SiStripArenaAllocator<U>& b) { return a.arena() != b.arena(); }
+#endif
@@ -0,0 +1,69 @@
+#ifndef SiStripMonitorTrack_SiStripEventFilterCache_h
+#define SiStripMonitorTrack_SiStripEventFilterCache_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripEventFilterCache
+//
+/**\class SiStripEventFilterCache SiStripEventFilterCache.h DQM/SiStripMonitorTrack/interface/SiStripEventFilterCache.h
+
+ Description: cached DCS decision and compiled HLT path selection of the event filters
+
+ Implementation:
+     DCS: with DCSMode 'Lumi' SiStripDCSStatus is asked at the first event of
+     each lumi section, with 'Scaler' whenever the ready word of the
+     DcsStatus scaler product differs from the previous event, and the
+     decision is reused otherwise. 'Event' asks at every event.
+     HLT: when FastHLT is on and the GenericTriggerEventFlag configuration
+     is a plain list of HLT path names (no DCS/GT/L1 part, no DB key, no
+     wildcards or logical operators), the names are turned into TriggerResults
+     indices once per trigger menu and the selection is a few bit tests with
+     the andOrHlt/errorReplyHlt semantics. Any other configuration keeps
+     GenericTriggerEventFlag.
+*/
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ParameterSet/interface/ParameterSetID.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+
+class SiStripDCSStatus;
+
+class SiStripEventFilterCache {
+public:
+  enum DCSMode { DCSEvent, DCSLumi, DCSScaler };
+
+  // pset: the EventFilterCache PSet, conf: the PSet of the GenericTriggerEventFlag
+  SiStripEventFilterCache(const edm::ParameterSet& pset, const edm::ParameterSet& conf);
+
+  // forget the cached decisions and the compiled trigger menu
+  void beginRun();
+  bool dcsStatus(SiStripDCSStatus& dcs, const edm::Event& e, const edm::EventSetup& es);
+
+  // the HLT selection is done here instead of by GenericTriggerEventFlag
+  inline bool fastHlt() const { return fastHlt_; }
+  bool acceptHlt(const edm::Event& e);
+
+private:
+  static const uint32_t invalid = 0xffffffff;
+
+  DCSMode  dcsMode_;
+  bool     dcsValid_;
+  bool     dcsDecision_;
+  uint32_t dcsRun_, dcsLumi_, dcsWord_;
+
+  bool fastHlt_;
+  edm::InputTag hltInputTag_;
+  std::vector<std::string> hltPaths_;
+  bool andOrHlt_;
+  bool errorReplyHlt_;
+  edm::ParameterSetID menuID_;
+  std::vector<uint32_t> hltIndices_;   // invalid for the paths not in the menu
+};
+#endif
@@ -0,0 +1,75 @@
+#ifndef SiStripMonitorTrack_SiStripFillQueue_h
+#define SiStripMonitorTrack_SiStripFillQueue_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripFillQueue
+//
+/**\class SiStripFillQueue SiStripFillQueue.h DQM/SiStripMonitorTrack/interface/SiStripFillQueue.h
+
+ Description: queue of the 1D histogram fills of the cluster loop, over one or several events
+
+ Implementation:
+     fill() appends a (ME, x, weight) record to a vector instead of touching
+     the histogram. endEvent() tells when BatchEvents events have been queued
+     or the records exceed BatchMemoryMB; flush() then sorts the records by
+     ME and value and fills the MEs one after the other. The vector keeps its
+     capacity, after the first batches no allocation is done. With
+     Aggregate, the records of a run with the same ME and value are added in
+     one go: the first one is filled through the MonitorElement, the others
+     go to the bin content, the sum of squared weights, the statistics and
+     the entries as TH1::Fill would have done. Only 1D histograms can be
+     queued. Up to the order of the floating point additions the histograms
+     are the same as with direct fills.
+*/
+
+#include <vector>
+
+#include <stdint.h>
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+class MonitorElement;
+class TH1;
+
+class SiStripFillQueue {
+public:
+  explicit SiStripFillQueue(const edm::ParameterSet& pset);
+
+  inline bool on() const { return on_; }
+  inline void fill(MonitorElement* me, float x, float w) {
+    Record record = { me, x, w };
+    records_.push_back(record);
+  }
+  // end of an event: true when the batch is complete and has to be flushed
+  inline bool endEvent() { return ++nEvents_ >= batchEvents_ || records_.size() >= maxRecords_; }
+  // fills the queued records, at the end of a batch and before the MEs are read or reset
+  void flush();
+
+  // n fills at x of total weight sumw and squared weight sumw2 added to h as
+  // TH1::Fill would have done them (the aggregated part of a run)
+  static void addFills(TH1* h, double x, uint32_t n, double sumw, double sumw2, bool unitWeights);
+
+private:
+  struct Record {
+    MonitorElement* me;
+    float x;
+    float w;
+    inline bool operator<(const Record& other) const {
+      if (me != other.me) return me < other.me;
+      if (x != other.x) return x < other.x;
+      return w > other.w;
+    }
+  };
+  // records [first, last) with the same ME and value
+  void fillRun(const Record* first, const Record* last);
+
+  bool on_;
+  bool aggregate_;
+  uint32_t batchEvents_;
+  size_t   maxRecords_;
+  uint32_t nEvents_;
+  std::vector<Record> records_;
+};
+#endif
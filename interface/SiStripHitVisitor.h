@@ -0,0 +1,93 @@
+#ifndef SiStripMonitorTrack_SiStripHitVisitor_h
+#define SiStripMonitorTrack_SiStripHitVisitor_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+//
+/**\file SiStripHitVisitor.h DQM/SiStripMonitorTrack/interface/SiStripHitVisitor.h
+
+ Description: strip clusters of a tracking hit, shared by SiStripMonitorTrack and SiStripMonitorMuonHLT
+
+ Implementation:
+     The hit is classified once with trackerHitRTTI (single, projected or
+     matched) and the concrete type is reached with a static_cast, so no
+     dynamic_cast is done per hit. For each strip cluster of the hit (two for
+     a matched hit) the visitor is called with a SiStripHitCluster pointing to
+     the cluster, its reference and the DetUnit it is on: the mono and stereo
+     clusters of a matched hit are taken in place, no SiStripRecHit2D is
+     copied.
+*/
+
+#include <stdint.h>
+
+#include "DataFormats/TrackingRecHit/interface/TrackingRecHit.h"
+#include "DataFormats/TrackerRecHit2D/interface/trackerHitRTTI.h"
+#include "DataFormats/TrackerRecHit2D/interface/OmniClusterRef.h"
+#include "DataFormats/TrackerRecHit2D/interface/TrackerSingleRecHit.h"
+#include "DataFormats/TrackerRecHit2D/interface/SiStripMatchedRecHit2D.h"
+#include "DataFormats/TrackerRecHit2D/interface/ProjectedSiStripRecHit2D.h"
+#include "DataFormats/SiStripDetId/interface/StripSubdetector.h"
+#include "Geometry/TrackerGeometryBuilder/interface/TrackerGeometry.h"
+#include "Geometry/TrackerGeometryBuilder/interface/GluedGeomDet.h"
+
+struct SiStripHitCluster {
+  const SiStripCluster* cluster;
+  const OmniClusterRef* ref;
+  uint32_t              detid;   // of the DetUnit
+  const GeomDetUnit*    unit;    // DetUnit of the cluster (a StripGeomDetUnit)
+  const GeomDet*        hitDet;  // det of the hit: the glued det for matched and projected hits
+};
+
+// calls visitor(const SiStripHitCluster&) for each strip cluster of hit, returns their number
+template <class Visitor>
+inline unsigned int visitStripHit(const TrackingRecHit& hit, const TrackerGeometry& geom, Visitor visitor)
+{
+  if (!hit.isValid() || hit.geographicalId().det() != DetId::Tracker) return 0;
+  // pixel hits are single hits too
+  if (hit.geographicalId().subdetId() < StripSubdetector::TIB) return 0;
+
+  SiStripHitCluster c;
+  if (trackerHitRTTI::isSingle(hit)) {
+    const TrackerSingleRecHit& single = static_cast<const TrackerSingleRecHit&>(hit);
+    c.detid  = hit.geographicalId().rawId();
+    c.unit   = geom.idToDetUnit(hit.geographicalId());
+    c.hitDet = c.unit;
+    if (c.unit == 0) return 0;
+    c.ref     = &single.omniClusterRef();
+    c.cluster = &single.stripCluster();
+    visitor(c);
+    return 1;
+  }
+  if (trackerHitRTTI::isMatched(hit)) {
+    const SiStripMatchedRecHit2D& matched = static_cast<const SiStripMatchedRecHit2D&>(hit);
+    const GluedGeomDet* glued = static_cast<const GluedGeomDet*>(geom.idToDet(hit.geographicalId()));
+    if (glued == 0) return 0;
+    c.hitDet  = glued;
+    c.unit    = glued->monoDet();
+    c.detid   = c.unit->geographicalId().rawId();
+    c.ref     = &matched.monoClusterRef();
+    c.cluster = &matched.monoCluster();
+    visitor(c);
+    c.unit    = glued->stereoDet();
+    c.detid   = c.unit->geographicalId().rawId();
+    c.ref     = &matched.stereoClusterRef();
+    c.cluster = &matched.stereoCluster();
+    visitor(c);
+    return 2;
+  }
+  if (trackerHitRTTI::isProjected(hit)) {
+    const SiStripRecHit2D& original = static_cast<const ProjectedSiStripRecHit2D&>(hit).originalHit();
+    const GluedGeomDet* glued = static_cast<const GluedGeomDet*>(geom.idToDet(hit.geographicalId()));
+    if (glued == 0) return 0;
+    c.hitDet  = glued;
+    c.detid   = original.geographicalId().rawId();
+    c.unit    = StripSubdetector(c.detid).stereo() ? glued->stereoDet() : glued->monoDet();
+    c.ref     = &original.omniClusterRef();
+    c.cluster = &original.stripCluster();
+    visitor(c);
+    return 1;
+  }
+  return 0;
+}
+#endif
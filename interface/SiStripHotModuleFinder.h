@@ -0,0 +1,86 @@
+#ifndef SiStripMonitorTrack_SiStripHotModuleFinder_h
+#define SiStripMonitorTrack_SiStripHotModuleFinder_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripHotModuleFinder
+//
+/**\class SiStripHotModuleFinder SiStripHotModuleFinder.h DQM/SiStripMonitorTrack/interface/SiStripHotModuleFinder.h
+
+ Description: per-module flag table (static exclusions and hot modules found online)
+
+ Implementation:
+     Modules get a dense index at booking time. The flag table and the
+     occupancy counters are flat arrays on that index, so both the exclusion
+     test and the counting are O(1) per module once the index is known. The
+     detid to index lookup itself is a hash map: strip detids are sparse 32 bit
+     numbers, and the lookup is done once per DetSet or on-track hit and its
+     index reused for all the clusters of it. Every CheckInterval events the
+     occupancy of each module is compared with the median of its layer and
+     modules above OccupancyFactor x median are flagged Hot until the next check
+     finds them back to normal. Excluded modules are left out of the medians.
+     With low occupancy (cosmics) the median of a layer is often 0: any module
+     with at least MinClusters clusters over the interval is then flagged.
+     Excluded detids without an index (not in the cabling) are kept in a set,
+     tested only for the modules without index.
+*/
+
+#include <vector>
+#include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+class SiStripHotModuleFinder {
+public:
+  enum Flag { Excluded = 0x1, Hot = 0x2 };
+  static const uint32_t invalidIndex = 0xffffffff;
+
+  explicit SiStripHotModuleFinder(const edm::ParameterSet&);
+
+  // detids and their layer number (0..nlayers-1), resets counters and flags
+  void setModules(const std::vector<uint32_t>& detids, const std::vector<uint16_t>& layers);
+  void exclude(const std::vector<uint32_t>& detids);
+  // counters and Hot flags back to their state after setModules/exclude
+  void reset();
+
+  inline bool     on() const { return on_; }
+  inline uint32_t size() const { return detIds_.size(); }
+  inline uint32_t detId(uint32_t index) const { return detIds_[index]; }
+  inline uint32_t index(uint32_t detid) const {
+    std::unordered_map<uint32_t, uint32_t>::const_iterator it = index_.find(detid);
+    return it == index_.end() ? invalidIndex : it->second;
+  }
+  inline uint8_t flags(uint32_t index) const { return index == invalidIndex ? 0 : flags_[index]; }
+  inline bool excluded(uint32_t index, uint32_t detid) const {
+    if (index == invalidIndex) return !excludedUnlisted_.empty() && excludedUnlisted_.count(detid);
+    return flags_[index] & Excluded;
+  }
+  inline bool hot(uint32_t index) const { return flags(index) & Hot; }
+  inline void count(uint32_t index, uint32_t nclusters) { if (on_ && index != invalidIndex) occupancy_[index] += nclusters; }
+
+  // to be called once per event; returns true when the Hot flags have been re-evaluated
+  bool endEvent();
+  const std::vector<uint32_t>& hotModules() const { return hotModules_; }
+
+private:
+  void evaluate();
+
+  bool     on_;
+  double   occupancyFactor_;
+  uint32_t minClusters_;
+  uint32_t checkInterval_;
+  uint32_t nEvents_;
+
+  std::vector<uint32_t> detIds_;
+  std::unordered_map<uint32_t, uint32_t> index_;
+  std::vector<uint16_t> layers_;
+  std::vector<uint8_t>  flags_;
+  std::unordered_set<uint32_t> excludedUnlisted_;
+  std::vector<uint32_t> occupancy_;
+  std::vector<std::vector<uint32_t> > layerOccupancy_;  // scratch for the medians
+  std::vector<uint32_t> hotModules_;
+};
+#endif
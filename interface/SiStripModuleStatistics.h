@@ -0,0 +1,85 @@
+#ifndef SiStripMonitorTrack_SiStripModuleStatistics_h
+#define SiStripMonitorTrack_SiStripModuleStatistics_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripModuleStatistics
+//
+/**\class SiStripModuleStatistics SiStripModuleStatistics.h DQM/SiStripMonitorTrack/interface/SiStripModuleStatistics.h
+
+ Description: streaming per-module statistics of the on-track cluster quantities
+
+ Implementation:
+     Replaces the module level histograms when they are only looked at through
+     a few numbers. For every module (dense index, as SiStripHotModuleFinder)
+     and quantity it keeps the Welford running mean and sum of squared
+     deviations and a fixed-size sketch: QuantileBins counters over the range
+     of the corresponding histogram, from which the median and the most
+     probable value are estimated. All the arrays are contiguous, indexed by
+     module*nQuantities+quantity. The values are written, one ME per layer, to
+     a 2D histogram with the modules of the layer on x and the statistics of
+     each quantity on y.
+*/
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+class MonitorElement;
+class DQMStore;
+
+class SiStripModuleStatistics {
+public:
+  enum Quantity { StoNCorr = 0, Charge, ChargeCorr, Width, nQuantities };
+  enum Statistic { Entries = 0, Mean, RMS, Median, MPV, nStatistics };
+
+  explicit SiStripModuleStatistics(const edm::ParameterSet&);
+
+  inline bool on() const { return on_; }
+  void setRange(Quantity q, double xmin, double xmax);
+  // detids and their layer number (0..nlayers-1), the index of a module is its position in detids
+  void setModules(const std::vector<uint32_t>& detids, const std::vector<uint16_t>& layers);
+  void reset();
+
+  inline uint16_t nLayers() const { return layerModules_.size(); }
+  inline uint32_t nModules(uint16_t layer) const { return layerModules_[layer].size(); }
+
+  inline void fill(uint32_t index, Quantity q, float x) {
+    uint32_t k = index*nQuantities + q;
+    // Welford update of the mean and of the sum of squared deviations
+    double n = ++n_[k];
+    double delta = x - mean_[k];
+    mean_[k] += delta/n;
+    m2_[k]   += delta*(x - mean_[k]);
+    int bin = int((x - xmin_[q])*invBinWidth_[q]);
+    if (bin < 0) bin = 0;
+    else if (bin >= int(nBins_)) bin = nBins_ - 1;
+    ++sketch_[k*nBins_ + bin];
+  }
+
+  // book the summary ME of a layer in the current folder of dbe
+  MonitorElement* book(DQMStore* dbe, const std::string& name, uint16_t layer) const;
+  // write the statistics of the modules of layer into its summary ME
+  void fill(MonitorElement* me, uint16_t layer) const;
+
+private:
+  double quantile(uint32_t k, Quantity q, double fraction) const;
+  double mostProbable(uint32_t k, Quantity q) const;
+
+  bool     on_;
+  uint32_t nBins_;
+  double   xmin_[nQuantities];
+  double   invBinWidth_[nQuantities];
+
+  std::vector<uint32_t> detIds_;
+  std::vector<std::vector<uint32_t> > layerModules_;   // module indices of each layer
+
+  std::vector<uint32_t> n_;
+  std::vector<double>   mean_;
+  std::vector<double>   m2_;
+  std::vector<uint32_t> sketch_;
+};
+#endif
@@ -6,6 +6,8 @@
 #include <memory>
 #include <string>
 #include <cmath>
+#include <algorithm>
+#include <chrono>
 
 // user include files
 #include "FWCore/Framework/interface/Frameworkfwd.h"
@@ -13,6 +15,7 @@
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
 #include "FWCore/MessageLogger/interface/MessageLogger.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
 #include "FWCore/Framework/interface/ESHandle.h"
@@ -31,6 +34,9 @@
 #include "DataFormats/TrackerRecHit2D/interface/SiStripRecHit1D.h"
 #include "DataFormats/TrackerRecHit2D/interface/SiStripMatchedRecHit2D.h"
 #include "DataFormats/TrackerRecHit2D/interface/ProjectedSiStripRecHit2D.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripHitVisitor.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripConditionsContext.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripTkHistoMapAccumulator.h"
 
 #include "Geometry/Records/interface/GlobalTrackingGeometryRecord.h"
 #include "Geometry/CommonDetUnit/interface/GeomDet.h"
@@ -44,6 +50,7 @@
 
 #include "DQM/SiStripCommon/interface/TkHistoMap.h"
 #include "DQM/SiStripCommon/interface/SiStripFolderOrganizer.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripClusterFeatures.h"
 
 #include "CalibTracker/SiStripCommon/interface/TkDetMap.h"
 
@@ -87,8 +94,18 @@ class SiStripMonitorMuonHLT : public edm::EDAnalyzer {
       MonitorElement* EtaDistribL3MuTrackClustersMap;
       MonitorElement* PhiDistribL3MuTrackClustersMap;
   };
+  //eta/phi bins of a layer and their normalisation (sensitive area)
+  struct LayerNorm{
+      std::vector<float> BinEta;
+      std::vector<float> BinPhi;
+      std::vector<float> ModNormEta;
+      std::vector<float> ModNormPhi;
+  };
 						    
 
+  //cluster sets filled in the LayerMEs
+  enum ClusterSet { AllClusters = 0, OnTrackClusters, L3MuTrackClusters };
+
   public:
       explicit SiStripMonitorMuonHLT(const edm::ParameterSet& ps);
       ~SiStripMonitorMuonHLT();
@@ -96,12 +113,17 @@ class SiStripMonitorMuonHLT : public edm::EDAnalyzer {
    private:
       virtual void beginRun(const edm::Run& run, const edm::EventSetup& es);
       virtual void analyze(const edm::Event&, const edm::EventSetup&);
+      virtual void endLuminosityBlock(const edm::LuminosityBlock&, const edm::EventSetup&);
       void analyzeOnTrackClusters( const reco::Track* l3tk, const TrackerGeometry & theTracker, bool isL3MuTrack = true );
+      template <ClusterSet set> void fillClusterMEs(LayerMEs & layerMEs, int layer, float eta, float phi);
       virtual void endJob() ;
       void createMEs(const edm::EventSetup& es);
+      void updateAdaptivePrescale(double optionalTime, double l3MuTime, bool optionalDone);
       //methods needed for normalisation
-      float GetEtaWeight(std::string label, GlobalPoint gp);
-      float GetPhiWeight(std::string label, GlobalPoint gp);
+      float GetEtaWeight(int layer, float eta);
+      float GetPhiWeight(int layer, float phi);
+      //MEs of a TkDetMap layer, 0 outside 1..HistoNumber-1
+      inline LayerMEs* getLayerMEs(int layer){ return (layer > 0 && layer < HistoNumber) ? &LayerMEMap[layer] : 0; }
       void GeometryFromTrackGeom (std::vector<DetId> Dets,const TrackerGeometry & theTracker, const edm::EventSetup& iSetup,
                                   std::map<std::string,std::vector<float> > & m_PhiStripMod_Eta,std::map<std::string,std::vector<float> > & m_PhiStripMod_Nb);
       void Normalizer (std::vector<DetId> Dets,const TrackerGeometry & theTracker);
@@ -115,8 +137,23 @@ class SiStripMonitorMuonHLT : public edm::EDAnalyzer {
       std::string monitorName_;
       std::string outputFile_;
       int counterEvt_;      ///counter
+      int counterPrescaled_;    ///events past prescaleEvt_, counter of the adaptive prescale
+      SiStripConditionsContext conditions_;   ///geometry and topology, fetched once per IOV
       int nTrig_;           /// mutriggered events
       int prescaleEvt_;     ///every n events
+      //adaptive prescale (timeBudget > 0): the all-clusters and track parts run every
+      //adaptivePrescale_ events so that the mean time per event stays within the budget,
+      //the L3 muon part runs on every event
+      double timeBudget_;       ///microseconds per event
+      int maxPrescale_;
+      int adaptivePrescale_;
+      double costL3Mu_;         ///running mean time of the L3 muon part, us per event
+      double costOptional_;     ///running mean time of the optional parts, us per processed event
+      int lumiEvents_;
+      int lumiOptionalEvents_;
+      double lumiTime_;
+      MonitorElement* effectivePrescaleME_;
+      MonitorElement* meanTimeME_;
       bool verbose_;
       bool normalize_;
       bool printNormalize_;
@@ -130,14 +167,24 @@ class SiStripMonitorMuonHLT : public edm::EDAnalyzer {
       edm::InputTag clusterCollectionTag_;
       edm::InputTag l3collectionTag_;
       edm::InputTag TrackCollectionTag_;
+      edm::InputTag clusterFeaturesTag_;  //SiStripClusterFeatures, if set used for all clusters
+      bool featuresSourceLogged_;         //cluster source of the feature table reported once
 
       int HistoNumber; //nof layers in Tracker = 34 
       TkDetMap* tkdetmap_;
-      std::map<std::string, LayerMEs> LayerMEMap;
+      std::vector<LayerMEs> LayerMEMap;    //indexed by TkDetMap layer, names used only at booking
+      std::vector<LayerNorm> LayerNormMap; //idem
       //2D info from TkHistoMap 
       TkHistoMap* tkmapAllClusters;
       TkHistoMap* tkmapOnTrackClusters;
       TkHistoMap* tkmapL3MuTrackClusters;
+      //cluster counts per strip module, added to the TkHistoMaps at lumi end
+      SiStripTkHistoMapAccumulator tkmapAllClustersAcc_;
+      SiStripTkHistoMapAccumulator tkmapOnTrackClustersAcc_;
+      SiStripTkHistoMapAccumulator tkmapL3MuTrackClustersAcc_;
+      //the three accumulators share the module list, so one index serves all of them
+      inline uint32_t moduleIndex (uint32_t detid) const { return tkmapAllClustersAcc_.index (detid); }
+      void addToTkHistoMap (SiStripTkHistoMapAccumulator & acc, TkHistoMap * map, uint32_t index, uint32_t detid, uint32_t n);
 
     
       // FOR NORMALISATION     
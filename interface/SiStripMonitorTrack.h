@@ -6,6 +6,7 @@
 #include <memory>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string>
 
@@ -26,6 +27,7 @@
 #include "DataFormats/Common/interface/Handle.h"
 #include "DataFormats/Common/interface/DetSetVector.h"
 #include "DataFormats/Common/interface/DetSetNew.h"
+#include "DataFormats/Common/interface/DetSetVectorNew.h"
 #include "DataFormats/TrackingRecHit/interface/TrackingRecHit.h"
 #include "DataFormats/SiStripCluster/interface/SiStripCluster.h"
 #include "DataFormats/TrackReco/interface/Track.h"
@@ -35,8 +37,24 @@
 #include "TrackingTools/PatternTools/interface/Trajectory.h"
 #include "TrackingTools/PatternTools/interface/TrajTrackAssociation.h"
 #include "CalibFormats/SiStripObjects/interface/SiStripDetCabling.h"
+#include "MagneticField/Engine/interface/MagneticField.h"
 
 #include "DQM/SiStripCommon/interface/SiStripFolderOrganizer.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripConditionsContext.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripEventFilterCache.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripEventArena.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripFillQueue.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripCacheLineArray.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripTkHistoMapAccumulator.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripHotModuleFinder.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripModuleStatistics.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripPGVAccumulator.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripApvAccumulator.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripQualityTests.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripClusterSampler.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripTrendBuffer.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripClusterFeatures.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripHitVisitor.h"
 #include "DQMServices/Core/interface/DQMStore.h"
 #include "DQMServices/Core/interface/MonitorElement.h"
 
@@ -48,6 +66,7 @@
 
 class SiStripDCSStatus;
 class GenericTriggerEventFlag;
+class SiStripClusterNtupleWriter;
 class TrackerTopology;
 //
 // class declaration
@@ -62,38 +81,94 @@ public:
   virtual void beginRun(const edm::Run& run, const edm::EventSetup& c);
   virtual void endJob(void);
   virtual void analyze(const edm::Event&, const edm::EventSetup&);
+  virtual void endLuminosityBlock(const edm::LuminosityBlock&, const edm::EventSetup&);
+  virtual void endRun(const edm::Run& run, const edm::EventSetup& c);
 
 private:
   enum ClusterFlags {
     OffTrack,
     OnTrack
   };
+  // ME binnings, one per TH1*/TProfile* PSet of the configuration
+  enum BinningLabel {
+    TH1nClustersOn,
+    TH1nClustersOff,
+    TH1ClusterCharge,
+    TH1ClusterStoN,
+    TH1ClusterChargeCorr,
+    TH1ClusterStoNCorr,
+    TH1ClusterStoNCorrMod,
+    TH1ClusterNoise,
+    TH1ClusterWidth,
+    TH1RawCommonMode,
+    TH1RawNoise,
+    TH1RawOccupancy,
+    TH1DeltaCosRZ,
+    TProfileClusterPGV,
+    NBinningLabels
+  };
+  struct BinningSpec {
+    int32_t Nbinx;
+    double  xmin, xmax;
+    int32_t Nbiny;   // 0 if not in the PSet
+    double  ymin, ymax;
+    int32_t Nbinz;
+    double  zmin, zmax;
+  };
   //booking
   void book(const TrackerTopology* tTopo);
+  void resetMEs();
   void bookModMEs(const uint32_t& );
-  void bookLayerMEs(const uint32_t&, std::string&);
-  void bookSubDetMEs(std::string& name);
-  MonitorElement * bookME1D(const char*, const char*);
-  MonitorElement * bookME2D(const char*, const char*);
-  MonitorElement * bookME3D(const char*, const char*);
-  MonitorElement * bookMEProfile(const char*, const char*);
-  MonitorElement * bookMETrend(const char*, const char*);
+  void bookLayerMEs(const uint32_t&, std::string&, unsigned int input);
+  void bookSubDetMEs(std::string& name, unsigned int input);
+  void parseBinnings();
+  MonitorElement * bookME1D(BinningLabel, const char*);
+  MonitorElement * bookME2D(BinningLabel, const char*);
+  MonitorElement * bookME3D(BinningLabel, const char*);
+  MonitorElement * bookMEProfile(BinningLabel, const char*);
+  MonitorElement * bookMETrend(BinningLabel, const char*);
   // internal evaluation of monitorables
-  void AllClusters(const edm::Event& ev, const edm::EventSetup& es); 
-  void trackStudy(const edm::Event& ev, const edm::EventSetup& es);
+  // the event path gets the EventSetup products from the conditions context, resolved once per IOV
+  void AllClusters(const edm::Handle< edmNew::DetSetVector<SiStripCluster> >& clusters, const edm::EventSetup& es, const SiStripConditionsContext& conditions); 
+  void trackStudy(const edm::Event& ev, const edm::EventSetup& es, const SiStripConditionsContext& conditions);
+  void trackStudyFromTracks(const edm::Event& ev, const edm::EventSetup& es, const SiStripConditionsContext& conditions);
+  void rawDigiStudy(const edm::Event& ev, const edm::EventSetup& es, const SiStripConditionsContext& conditions);
+  void hitStudy(const TrackingRecHit* hit, const TrajectoryStateOnSurface* tsos, reco::TrackRef trackref, const edm::EventSetup& es, const SiStripConditionsContext& conditions);
+  LocalVector hitDirection(const GeomDet* det, const GeomDet* hitdet, const TrajectoryStateOnSurface* tsos, const reco::Track& track, const SiStripConditionsContext& conditions);
+  LocalVector helixDirection(const reco::Track& track, const GeomDet& det, const SiStripConditionsContext& conditions) const;
   //  LocalPoint project(const GeomDet *det,const GeomDet* projdet,LocalPoint position,LocalVector trackdirection)const;
-  bool clusterInfos(SiStripClusterInfo* cluster, const uint32_t& detid, const TrackerTopology* tTopo, enum ClusterFlags flags, LocalVector LV);	
-  template <class T> void RecHitInfo(const T* tkrecHit, LocalVector LV,reco::TrackRef track_ref, const edm::EventSetup&);
+  // quantities of one cluster, from SiStripClusterInfo or from the shared SiStripClusterFeatures
+  struct ClusterValues {
+    float    StoN;
+    float    noise;
+    uint16_t charge;
+    uint16_t width;
+    float    position;
+    const SiStripCluster* cluster;
+  };
+  void clusterValues(const SiStripClusterInfo& info, const SiStripCluster& cluster, ClusterValues& values) const;
+  void clusterValues(const SiStripClusterFeatures& features, unsigned int row, const SiStripCluster& cluster, ClusterValues& values) const;
+  bool passClusterQuality(const ClusterValues& cluster) const;
+  bool clusterInfos(const ClusterValues& cluster, const uint32_t& detid, uint32_t modIndex, enum ClusterFlags flags, LocalVector LV);	
+  void clusterStudy(const SiStripHitCluster& hitCluster, LocalVector LV, uint32_t track, const edm::EventSetup&, const SiStripConditionsContext&);
 
   // fill monitorables 
-  void fillModMEs(SiStripClusterInfo*,std::string,float);
-  void fillMEs(SiStripClusterInfo*,uint32_t detid, const TrackerTopology* tTopo, float,enum ClusterFlags);
+  void fillModMEs(const ClusterValues&,uint32_t detid,float,uint32_t);
+  void flushPGV();
+  struct ModuleMEs;
+  void fillMEs(const ClusterValues&,uint32_t detid, const ModuleMEs&, float,enum ClusterFlags);
   inline void fillME(MonitorElement* ME,float value1){if (ME!=0)ME->Fill(value1);}
   inline void fillME(MonitorElement* ME,float value1,float value2){if (ME!=0)ME->Fill(value1,value2);}
   inline void fillME(MonitorElement* ME,float value1,float value2,float value3){if (ME!=0)ME->Fill(value1,value2,value3);}
   inline void fillME(MonitorElement* ME,float value1,float value2,float value3,float value4){if (ME!=0)ME->Fill(value1,value2,value3,value4);}
+  // 1D histograms filled per cluster or per event: queued with DeferredFills.On, filled directly otherwise
+  inline void queueME(MonitorElement* ME,float value){if (ME!=0){if (fillQueue_.on()) fillQueue_.fill(ME,value,1.); else ME->Fill(value);}}
+  inline void queueME(MonitorElement* ME,float value,float weight){if (ME!=0){if (fillQueue_.on()) fillQueue_.fill(ME,value,weight); else ME->Fill(value,weight);}}
 
   void getSubDetTag(std::string& folder_name, std::string& tag);   
+  void publishHotModules();
+  void publishModuleStatistics();
+  void fillTrends();
   // ----------member data ---------------------------
   
 private:
@@ -105,7 +180,16 @@ private:
   
   //******* TkHistoMaps
   TkHistoMap *tkhisto_StoNCorrOnTrack, *tkhisto_NumOnTrack, *tkhisto_NumOffTrack;  
+  // per-module sums of the TkHistoMaps on the module index of hotModuleFinder_, written at lumi end
+  SiStripTkHistoMapAccumulator tkhistoAccStoNCorrOnTrack_, tkhistoAccNumOnTrack_, tkhistoAccNumOffTrack_;
+  void flushTkHistoMaps();
   //******** TkHistoMaps
+
+  // booking is redone only when the cabling or the geometry change, and then
+  // only for the modules not booked yet; otherwise the MEs are reset in place
+  bool booked_;
+  std::map<uint32_t, std::string> bookedModules_;  // detid -> layer id
+  std::vector<MonitorElement*> bookedMEs_;          // booked with bookME* and the cluster positions
  
   struct ModMEs{  
     MonitorElement* ClusterStoNCorr;
@@ -116,6 +200,8 @@ private:
     MonitorElement* ClusterPGV;
   };
 
+  struct LayerFills;
+  struct SubDetFills;
   struct LayerMEs{
     MonitorElement* ClusterStoNCorrOnTrack;
     MonitorElement* ClusterChargeCorrOnTrack;
@@ -127,10 +213,14 @@ private:
     MonitorElement* ClusterWidthOffTrack;
     MonitorElement* ClusterPosOnTrack;
     MonitorElement* ClusterPosOffTrack;
+    MonitorElement* RawCommonMode;
+    MonitorElement* RawNoise;
+    MonitorElement* RawOccupancyOnTrack;
+    int qtStoNCorr;   // units of the quality tests, -1 if not tested
+    int qtWidth;
+    LayerFills* fills;
   };
   struct SubDetMEs{
-    int totNClustersOnTrack;
-    int totNClustersOffTrack;
     MonitorElement* nClustersOnTrack;
     MonitorElement* nClustersTrendOnTrack;
     MonitorElement* nClustersOffTrack;
@@ -138,34 +228,192 @@ private:
     MonitorElement* ClusterStoNCorrOnTrack;
     MonitorElement* ClusterChargeOffTrack;
     MonitorElement* ClusterStoNOffTrack;
- 
+    MonitorElement* DeltaCosRZHelixOnTrack;
+    MonitorElement* ClusterStoNCorrSharedOnTrack;
+    SiStripTrendBuffer TrendOnTrack;
+    SiStripTrendBuffer TrendOffTrack;
+    int qtStoNCorr;
+    SubDetFills* fills;  // with the cluster counters of the event
   };  
   std::map<std::string, ModMEs> ModMEsMap;
   std::map<std::string, LayerMEs> LayerMEsMap;
   std::map<std::string, SubDetMEs> SubDetMEsMap;  
+
+  // Track collections monitored by this instance. The first one (TrackProducer/TrackLabel)
+  // is the primary: its on-track MEs are LayerMEsMap/SubDetMEsMap with the historical names,
+  // and it is the reference of the off-track MEs. The others (TrackInputs) only have
+  // on-track MEs and an off-track count, named with their Tag.
+  struct TrackInput {
+    std::string producer;
+    std::string label;
+    std::string suffix;
+    bool trajectoryInEvent;
+    std::map<std::string, LayerMEs> LayerMEsMap;
+    std::map<std::string, SubDetMEs> SubDetMEsMap;
+  };
+  std::vector<TrackInput> trackInputs_;
+  unsigned int currentInput_;
+  inline std::map<std::string, LayerMEs>& layerMEsMap(unsigned int input) { return input == 0 ? LayerMEsMap : trackInputs_[input].LayerMEsMap; }
+  inline std::map<std::string, SubDetMEs>& subDetMEsMap(unsigned int input) { return input == 0 ? SubDetMEsMap : trackInputs_[input].SubDetMEsMap; }
+
+  // ME pointers and counters read by the fills of one cluster, copied from the maps by
+  // buildModuleMEs into cache line aligned blocks: an on-track or off-track fill reads
+  // one line of the layer block, one of the sub-detector block and one of the module block
+  struct alignas(64) LayerFills {
+    // on-track, first line
+    MonitorElement* ClusterStoNCorrOnTrack;
+    MonitorElement* ClusterChargeCorrOnTrack;
+    MonitorElement* ClusterChargeOnTrack;
+    MonitorElement* ClusterNoiseOnTrack;
+    MonitorElement* ClusterWidthOnTrack;
+    MonitorElement* ClusterPosOnTrack;
+    int qtStoNCorr;
+    int qtWidth;
+    // off-track, second line
+    alignas(64) MonitorElement* ClusterChargeOffTrack;
+    MonitorElement* ClusterNoiseOffTrack;
+    MonitorElement* ClusterWidthOffTrack;
+    MonitorElement* ClusterPosOffTrack;
+    LayerMEs* mes;
+  };
+  struct alignas(64) SubDetFills {
+    MonitorElement* ClusterStoNCorrOnTrack;
+    MonitorElement* ClusterChargeOffTrack;
+    MonitorElement* ClusterStoNOffTrack;
+    MonitorElement* ClusterStoNCorrSharedOnTrack;
+    MonitorElement* DeltaCosRZHelixOnTrack;
+    int qtStoNCorr;
+    int totNClustersOnTrack;
+    int totNClustersOffTrack;
+  };
+  struct alignas(64) ModFills {
+    ModMEs mes;
+    bool   booked;
+  };
+  static_assert(sizeof(LayerFills) == 128 && sizeof(SubDetFills) == 64 && sizeof(ModFills) == 64, "fill blocks off their cache lines");
+  SiStripCacheLineArray<LayerFills>  layerFills_;
+  SiStripCacheLineArray<SubDetFills> subDetFills_;
+  SiStripCacheLineArray<ModFills>    modFills_;    // per module index
+
+  // blocks of each module and track input: index hotModuleFinder_.index(detid)*trackInputs_.size() + input
+  struct ModuleMEs {
+    LayerFills*  layer;
+    SubDetFills* subdet;
+  };
+  std::vector<ModuleMEs> moduleMEs_;
+  std::map<uint32_t, std::vector<ModuleMEs> > unlistedModuleMEs_;  // modules not in the cabling
+  void buildModuleMEs(const std::vector<uint32_t>& detids);
+  void lookupModuleMEs(uint32_t detid, ModuleMEs* mes);
+  inline const ModuleMEs& moduleMEs(uint32_t detid, uint32_t modIndex, unsigned int input) {
+    if (modIndex != SiStripHotModuleFinder::invalidIndex) return moduleMEs_[modIndex*trackInputs_.size() + input];
+    return unlistedModuleMEs(detid)[input];
+  }
+  inline const ModuleMEs& moduleMEs(uint32_t detid, unsigned int input) {
+    return moduleMEs(detid, hotModuleFinder_.index(detid), input);
+  }
+  const std::vector<ModuleMEs>& unlistedModuleMEs(uint32_t detid);
+
+  // per-event scratch data, on eventArena_: released by releaseEventScratch() at the end of analyze
+  template <class T> using ScratchVector = std::vector<T, SiStripArenaAllocator<T> >;
+  SiStripEventArena eventArena_;
+  void releaseEventScratch();
+  SiStripFillQueue fillQueue_;
+
+  // on-track bit of each input for every cluster of Cluster_src, by offset in data()
+  ScratchVector<uint8_t> onTrackMask_;
+  const SiStripCluster* firstCluster_;
+  inline void markOnTrack(const SiStripCluster* cluster) {
+    if (firstCluster_ != 0 && cluster >= firstCluster_ && cluster < firstCluster_ + onTrackMask_.size())
+      onTrackMask_[cluster - firstCluster_] |= (1 << currentInput_);
+  }
+  static const uint32_t invalidRow = 0xffffffff;
+  inline uint32_t clusterRow(const SiStripCluster* cluster) const {
+    return (firstCluster_ != 0 && cluster >= firstCluster_ && cluster < firstCluster_ + onTrackMask_.size()) ? cluster - firstCluster_ : invalidRow;
+  }
+
+  // clusters met on the tracks of the current input, quantities computed for the first
+  // track only; the following tracks sharing a cluster are filled according to SharedClusters
+  enum SharedClusterPolicy { FillOnce = 0, FillPerTrack, FillShared };
+  SharedClusterPolicy sharedClusters_;
+  struct OnTrackCluster {
+    uint32_t row;
+    uint32_t track;
+    bool     passed;
+    ClusterValues values;
+  };
+  ScratchVector<int32_t> onTrackSlot_;   // per cluster of Cluster_src, index in onTrackClusters_ or -1
+  ScratchVector<OnTrackCluster> onTrackClusters_;
+  void resetOnTrackClusters();
   
-  edm::ESHandle<TrackerGeometry> tkgeom;
-  edm::ESHandle<SiStripDetCabling> SiStripDetCabling_;
+  SiStripConditionsContext conditions_;
+  // Product bits changed since the last beginRun: the updates of analyze
+  // (a new IOV within the run) must not hide a cabling or geometry change
+  unsigned int pendingChanges_;
   
-  edm::ParameterSet Parameters;
+  BinningSpec binnings_[NBinningLabels];
   edm::InputTag Cluster_src_;
+  edm::InputTag ClusterFeatures_;
   
   bool Mod_On_;
   bool Trend_On_;
+  int TrendNbins_;
+  int TrendSteps_;
+  int TrendUpdateMode_;
   bool OffHisto_On_;
   bool HistoFlag_On_;
   bool ring_flag;
   bool TkHistoMap_On_;
+  bool ClusterNtuple_On_;
 
-  std::string TrackProducer_;
-  std::string TrackLabel_;
+  bool layerontrack;
+  bool layerofftrack;
+  bool layercharge;
+  bool layerston;
+  bool layerchargecorr;
+  bool layerstoncorrontrack;
+  bool layernoise;
+  bool layerwidth;
+
+  bool HelixAngleValidation_;
 
   std::vector<uint32_t> ModulesToBeExcluded_;
-  std::vector<const SiStripCluster*> vPSiStripCluster;
+  SiStripHotModuleFinder hotModuleFinder_;
+  MonitorElement* HotModules;
+  MonitorElement* nHotModules;
+  std::string publishedHotModules_;  // hot list of the last publishHotModules, logged on change
+  // Mod_On with ModuleStatistics.On: per-module running statistics instead of ModMEs
+  SiStripModuleStatistics moduleStatistics_;
+  bool ModStatistics_On_;
+  std::vector<MonitorElement*> ModuleStatisticsMEs;
+  // Mod_On without ModuleStatistics: PGV sums per module, added to the PGV_OnTrack profiles at lumi end
+  SiStripPGVAccumulator pgvAccumulator_;
+  // per-APV on-track charge and StoN
+  bool APV_On_;
+  SiStripApvAccumulator apvAccumulator_;
+  MonitorElement* APVSummary;
+  // quality tests evaluated per lumi from running counters
+  SiStripQualityTests qualityTests_;
+  // off-track clusters analysed in detail on a weighted sample, counted exactly
+  SiStripClusterSampler clusterSampler_;
+  MonitorElement* SamplingFraction;
+
+  // strips under the on-track clusters of the event, for the raw digi study
+  struct OnTrackStrips {
+    uint32_t detid;
+    uint16_t firstStrip;
+    uint16_t width;
+    bool operator<(const OnTrackStrips& other) const { return detid < other.detid; }
+  };
+  ScratchVector<OnTrackStrips> vOnTrackStrips;
+
+  bool RawDigis_On_;
+  std::string RawDigiProducer_;
+  std::string RawDigiLabel_;
+  double RawDigiHitThreshold_;
   bool tracksCollection_in_EventTree;
   bool trackAssociatorCollection_in_EventTree;
   bool flag_ring;
-  int runNb, eventNb;
+  int runNb, eventNb, lumiNb;
   int firstEvent;
 
   bool   applyClusterQuality_;
@@ -176,6 +424,9 @@ private:
 
   SiStripDCSStatus* dcsStatus_;
   GenericTriggerEventFlag* genTriggerEventFlag_;
+  SiStripEventFilterCache eventFilterCache_;
+  SiStripClusterNtupleWriter* clusterNtuple_;
+  const SiStripClusterFeatures* clusterFeatures_;
   SiStripFolderOrganizer folderOrganizer_;                                                                                                                                                                                                                                   
 };
 #endif
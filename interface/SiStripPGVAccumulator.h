@@ -0,0 +1,84 @@
+#ifndef SiStripMonitorTrack_SiStripPGVAccumulator_h
+#define SiStripMonitorTrack_SiStripPGVAccumulator_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripPGVAccumulator
+//
+/**\class SiStripPGVAccumulator SiStripPGVAccumulator.h DQM/SiStripMonitorTrack/interface/SiStripPGVAccumulator.h
+
+ Description: per-module pulse shape (PGV) sums, added to the PGV_OnTrack TProfiles on flush
+
+ Implementation:
+     A cluster puts its strips, normalised to the highest one, at the integer
+     positions m, m+1, ... (m the index of the highest strip) and zeros at all
+     the other integer positions of [int(xmin), int(xmax)). Every position of
+     that range therefore gets exactly one entry per cluster: only the cluster
+     count and, per position, the sums of the strip values, of their squares
+     and the number of strips are kept. flush() turns them into the bin sums,
+     bin entries and statistics that the same TProfile::Fill calls would have
+     produced, and resets the module. Up to the order of the floating point
+     additions the TProfile is the same.
+*/
+
+#include <vector>
+#include <stdint.h>
+
+class MonitorElement;
+
+class SiStripPGVAccumulator {
+public:
+  SiStripPGVAccumulator();
+
+  // x and y ranges of the TProfile
+  void setRange(double xmin, double xmax, double ymin, double ymax);
+  void setModules(uint32_t nmodules);
+  void reset();
+
+  inline void fill(uint32_t index, const std::vector<uint8_t>& amplitudes) {
+    if (amplitudes.empty()) return;
+    uint32_t m = 0;
+    for (uint32_t i = 1; i < amplitudes.size(); ++i)
+      if (amplitudes[i] > amplitudes[m]) m = i;
+    int last = int(m + amplitudes.size()) - 1;
+    if (last >= high_) grow(last + 1);
+    if (nClusters_[index]++ == 0) dirty_.push_back(index);
+    float max = amplitudes[m];
+    Position* p = &positions_[index*stride_ + (int(m) - low_)];
+    for (uint32_t i = 0; i < amplitudes.size(); ++i, ++p) {
+      double y = amplitudes[i]/max;
+      ++p->n;
+      if (!accepted(y)) continue;
+      ++p->accepted;
+      p->sum  += y;
+      p->sum2 += y*y;
+    }
+  }
+
+  // add the clusters of the module to the TProfile of me and reset it
+  void flush(uint32_t index, MonitorElement* me);
+  // modules with clusters since the last flush
+  inline const std::vector<uint32_t>& dirty() const { return dirty_; }
+  inline void clearDirty() { dirty_.clear(); }
+
+private:
+  struct Position {
+    double   sum;
+    double   sum2;
+    uint32_t n;         // strips at this position
+    uint32_t accepted;  // strips within [ymin,ymax]
+  };
+  inline bool accepted(double y) const { return ymin_ == ymax_ || (y >= ymin_ && y <= ymax_); }
+  void grow(int high);
+
+  int    padLow_, padHigh_;   // integer positions padded with zeros: [padLow_, padHigh_)
+  double ymin_, ymax_;
+  int    low_, high_;         // positions kept: [low_, high_)
+  uint32_t stride_;
+
+  std::vector<uint32_t> nClusters_;
+  std::vector<Position> positions_;
+  std::vector<uint32_t> dirty_;
+};
+#endif
@@ -0,0 +1,87 @@
+#ifndef SiStripMonitorTrack_SiStripQualityTests_h
+#define SiStripMonitorTrack_SiStripQualityTests_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripQualityTests
+//
+/**\class SiStripQualityTests SiStripQualityTests.h DQM/SiStripMonitorTrack/interface/SiStripQualityTests.h
+
+ Description: quality tests of data/sistrip_qualitytest_track.xml evaluated while filling
+
+ Implementation:
+     Equivalent of the harvesting QTests MeanWithinExpected (useRange) on the
+     on-track StoNCorr summaries and ContentsXRange on the on-track width
+     summaries, computed from running counters kept next to the fills instead
+     of from the histograms. Each test has a list of units (layers or
+     sub-detectors), registered at booking, with a count and a sum (mean test)
+     or a count in range (contents test) per unit. Values outside the axis of
+     the corresponding histogram are ignored, as they would be by the
+     histogram statistics (x >= xmax goes to the overflow of TH1::Fill).
+     evaluate() writes the status (dqm::qstatus codes) and the tested value of
+     every unit into two MEs with one bin per unit: QTestStatus_/QTestValue_
+     per lumi section (lumi flag), QTestStatusRun_/QTestValueRun_ for the run.
+*/
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+class MonitorElement;
+class DQMStore;
+
+class SiStripQualityTests {
+public:
+  enum Test { StoNCorrMean = 0, WidthContents, nTests };
+
+  explicit SiStripQualityTests(const edm::ParameterSet&);
+
+  inline bool on() const { return on_; }
+  // range of the histogram the test stands for
+  void setAxisRange(Test t, double xmin, double xmax);
+  // returns the index of the unit, to be given to fill
+  int addUnit(Test t, const std::string& name);
+
+  inline void fill(Test t, int unit, double x) {
+    if (unit < 0 || x < axisMin_[t] || x >= axisMax_[t]) return;
+    Counters& c = lumi_[t][unit];
+    c.n   += 1.;
+    c.sum += (t == StoNCorrMean) ? x : (x >= xmin_[t] && x <= xmax_[t]);
+  }
+
+  // book the status and value MEs of each test in the current folder of dbe; booked
+  // again when units were added since the last call
+  void book(DQMStore* dbe);
+  // evaluate the tests on the counters of the lumi section (endRun: of the run) and
+  // write the results into the lumi (run) MEs; endLumi adds the lumi counters to the
+  // run ones, both reset them
+  void endLumi();
+  void endRun();
+
+private:
+  struct Counters {
+    double n;
+    double sum;
+  };
+  void evaluate(Test t, const std::vector<Counters>& counters, MonitorElement* status, MonitorElement* value) const;
+  void bookResults(DQMStore* dbe, const std::string& statusName, const std::string& valueName, int t,
+		   MonitorElement*& status, MonitorElement*& value);
+
+  bool     on_;
+  uint32_t minEntries_;
+  double   xmin_[nTests], xmax_[nTests];
+  double   error_[nTests], warning_[nTests];
+  double   axisMin_[nTests], axisMax_[nTests];
+
+  std::vector<std::string> units_[nTests];
+  std::vector<Counters>    lumi_[nTests];
+  std::vector<Counters>    run_[nTests];
+  MonitorElement* status_[nTests];     // per lumi section
+  MonitorElement* value_[nTests];
+  MonitorElement* runStatus_[nTests];  // per run
+  MonitorElement* runValue_[nTests];
+};
+#endif
@@ -0,0 +1,91 @@
+#ifndef SiStripMonitorTrack_SiStripTkHistoMapAccumulator_h
+#define SiStripMonitorTrack_SiStripTkHistoMapAccumulator_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripTkHistoMapAccumulator
+//
+/**\class SiStripTkHistoMapAccumulator SiStripTkHistoMapAccumulator.h DQM/SiStripMonitorTrack/interface/SiStripTkHistoMapAccumulator.h
+
+ Description: per-module sums of a TkHistoMap, written into it at lumi end
+
+ Implementation:
+     The modules given to setModules get a dense index (their position in the
+     list); add() is one relaxed atomic update of the flat count array, so it
+     can be called from several threads. flush(), not concurrent with add()
+     and fill(), writes the modules into the TkHistoMap and resets them.
+     Counts (add) go through TkHistoMap::add once per module: the same bin
+     content as one add per cluster. Values (fill, the profile mean of a
+     module) are summed in double with their squares, in one shard of flat
+     arrays per thread: each thread takes a slot on its first fill and creates
+     its shard there, threads beyond maxShards share an overflow shard under a
+     mutex. flush adds up the shards and adds the sum, the sum of squares and
+     the n entries of the module straight into the bin arrays of the
+     TProfile2D of the layer (bin content, Sumw2, bin entries and their Sumw2)
+     and into its statistics, as n unit weight fills would (addToBin). The
+     layer and bin of each module are looked up in the TkDetMap once, in
+     setModules.
+*/
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+class TkDetMap;
+class TkHistoMap;
+class TProfile2D;
+
+class SiStripTkHistoMapAccumulator {
+public:
+  static const uint32_t invalidIndex = 0xffffffff;
+
+  SiStripTkHistoMapAccumulator();
+
+  // modules of the index; with a TkDetMap the values of fill() are kept and the
+  // TkDetMap layer and bin of each module are cached
+  void setModules(const std::vector<uint32_t>& detids, TkDetMap* tkdetmap = 0);
+  inline uint32_t index(uint32_t detid) const {
+    std::unordered_map<uint32_t, uint32_t>::const_iterator it = index_.find(detid);
+    return it == index_.end() ? invalidIndex : it->second;
+  }
+
+  inline void add(uint32_t index, uint32_t n) { counts_[index].fetch_add(n, std::memory_order_relaxed); }
+  // only after setModules with a TkDetMap
+  void fill(uint32_t index, float value);
+
+  // adds the counts or values of the modules to map and resets them
+  void flush(TkHistoMap* map);
+
+  // n unit weight fills in bin (ix, iy) of profile, of values summing to sum
+  // and squares summing to sum2
+  static void addToBin(TProfile2D* profile, int ix, int iy, uint32_t n, double sum, double sum2);
+
+private:
+  static const unsigned int maxShards = 16;
+  struct Shard {
+    explicit Shard(uint32_t n) : sums(n, 0.), sums2(n, 0.) {}
+    std::vector<double> sums;
+    std::vector<double> sums2;
+  };
+  // slot of the calling thread, the same for all accumulators
+  static unsigned int threadSlot();
+
+  struct Bin {
+    int16_t layer;
+    int16_t ix;
+    int16_t iy;
+  };
+
+  std::vector<uint32_t> detIds_;
+  std::unordered_map<uint32_t, uint32_t> index_;
+  std::vector<Bin> bins_;  // with values only
+  std::vector<std::atomic<uint32_t> > counts_;
+  std::unique_ptr<Shard> shards_[maxShards];  // each one created and filled by the thread of its slot only
+  std::unique_ptr<Shard> overflow_;
+  std::mutex overflowMutex_;
+};
+#endif
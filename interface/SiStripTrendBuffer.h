@@ -0,0 +1,56 @@
+#ifndef SiStripMonitorTrack_SiStripTrendBuffer_h
+#define SiStripMonitorTrack_SiStripTrendBuffer_h
+
+// -*- C++ -*-
+//
+// Package:    SiStripMonitorTrack
+// Class:      SiStripTrendBuffer
+//
+/**\class SiStripTrendBuffer SiStripTrendBuffer.h DQM/SiStripMonitorTrack/interface/SiStripTrendBuffer.h
+
+ Description: fixed-size ring buffer of trend points (count, sum, sum of squares)
+
+ Implementation:
+     Each slot aggregates all the values appended with the same key (a lumi
+     section or a time interval number). A new key opens the next slot and
+     overwrites the oldest one, so appending is O(1) and the memory is fixed
+     whatever the run length. The TProfile of the ME is rewritten from the
+     buffer only when requested (fill), oldest slot in the first bin.
+*/
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+class MonitorElement;
+
+class SiStripTrendBuffer {
+public:
+  explicit SiStripTrendBuffer(unsigned int nslots = 0);
+
+  inline void append(uint32_t key, double value) {
+    if (slots_.empty()) return;
+    if (size_ == 0 || slots_[head_].key != key) open(key);
+    Slot& slot = slots_[head_];
+    slot.n    += 1.;
+    slot.sum  += value;
+    slot.sum2 += value*value;
+  }
+  void reset();
+  // rewrite the profile of me; slot keys are labelled as keyScale*key
+  void fill(MonitorElement* me, double keyScale) const;
+
+private:
+  struct Slot {
+    uint32_t key;
+    double n;
+    double sum;
+    double sum2;
+  };
+  void open(uint32_t key);
+
+  std::vector<Slot> slots_;
+  unsigned int head_;
+  unsigned int size_;
+};
+#endif
@@ -5,3 +5,5 @@
 #include "DQM/SiStripMonitorTrack/interface/SiStripMonitorTrack.h"
 DEFINE_FWK_MODULE(SiStripMonitorTrack);
 
+#include "DQM/SiStripMonitorTrack/interface/SiStripClusterFeatureProducer.h"
+DEFINE_FWK_MODULE(SiStripClusterFeatureProducer);
@@ -0,0 +1,79 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripClusterFeatureProducer.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripClusterFeatures.h"
+
+#include <memory>
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/Framework/interface/ESHandle.h"
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/Common/interface/DetSetVectorNew.h"
+#include "DataFormats/SiStripCluster/interface/SiStripCluster.h"
+#include "AnalysisDataFormats/SiStripClusterInfo/interface/SiStripClusterInfo.h"
+#include "Geometry/Records/interface/TrackerDigiGeometryRecord.h"
+#include "Geometry/TrackerGeometryBuilder/interface/TrackerGeometry.h"
+#include "Geometry/TrackerGeometryBuilder/interface/StripGeomDetUnit.h"
+#include "Geometry/CommonTopologies/interface/StripTopology.h"
+
+SiStripClusterFeatureProducer::SiStripClusterFeatureProducer(const edm::ParameterSet& conf):
+  Cluster_src_(conf.getParameter<edm::InputTag>("Cluster_src"))
+{
+  produces<SiStripClusterFeatures>();
+}
+
+//------------------------------------------------------------------------
+SiStripClusterFeatureProducer::~SiStripClusterFeatureProducer()
+{
+}
+
+//------------------------------------------------------------------------
+void SiStripClusterFeatureProducer::produce(edm::Event& ev, const edm::EventSetup& es)
+{
+  std::auto_ptr<SiStripClusterFeatures> features(new SiStripClusterFeatures());
+
+  edm::Handle< edmNew::DetSetVector<SiStripCluster> > siStripClusterHandle;
+  ev.getByLabel(Cluster_src_, siStripClusterHandle);
+  if (!siStripClusterHandle.isValid()) {
+    edm::LogError("SiStripClusterFeatureProducer") << "ClusterCollection is not valid!!" << std::endl;
+    features->detOffsets.push_back(0);
+    ev.put(features);
+    return;
+  }
+
+  edm::ESHandle<TrackerGeometry> tkgeom;
+  es.get<TrackerDigiGeometryRecord>().get(tkgeom);
+
+  const edmNew::DetSetVector<SiStripCluster>& clusters = *siStripClusterHandle;
+  features->clusterProductID = siStripClusterHandle.id();
+  features->reserve(clusters.size(), clusters.dataSize());
+
+  for (edmNew::DetSetVector<SiStripCluster>::const_iterator DSViter = clusters.begin(); DSViter != clusters.end(); ++DSViter) {
+    uint32_t detid = DSViter->id();
+    uint32_t detIndex = features->detIds.size();
+    features->detIds.push_back(detid);
+    features->detOffsets.push_back(features->StoN.size());
+
+    const StripGeomDetUnit* theGeomDet = dynamic_cast<const StripGeomDetUnit*>(tkgeom->idToDet(detid));
+    const StripTopology* topol = theGeomDet ? &(theGeomDet->specificTopology()) : 0;
+
+    for (edmNew::DetSet<SiStripCluster>::const_iterator ClusIter = DSViter->begin(); ClusIter != DSViter->end(); ++ClusIter) {
+      SiStripClusterInfo SiStripClusterInfo_(*ClusIter, es, detid);
+      features->detIndex.push_back(detIndex);
+      features->StoN.push_back(SiStripClusterInfo_.signalOverNoise());
+      features->noise.push_back(SiStripClusterInfo_.noiseRescaledByGain());
+      features->charge.push_back(SiStripClusterInfo_.charge());
+      features->width.push_back(SiStripClusterInfo_.width());
+      features->barycenter.push_back(SiStripClusterInfo_.baryStrip());
+      if (topol) {
+	GlobalPoint clustgp = theGeomDet->surface().toGlobal(topol->localPosition(ClusIter->barycenter()));
+	features->eta.push_back(clustgp.eta());
+	features->phi.push_back(clustgp.phi());
+      } else {
+	features->eta.push_back(0.);
+	features->phi.push_back(0.);
+      }
+    }
+  }
+  features->detOffsets.push_back(features->StoN.size());
+
+  ev.put(features);
+}
@@ -17,12 +17,14 @@
 //
 
 #include "DQM/SiStripMonitorTrack/interface/SiStripMonitorMuonHLT.h"
+#include "DataFormats/Provenance/interface/Provenance.h"
 
 
 //
 // constructors and destructor
 //
-SiStripMonitorMuonHLT::SiStripMonitorMuonHLT (const edm::ParameterSet & iConfig)
+SiStripMonitorMuonHLT::SiStripMonitorMuonHLT (const edm::ParameterSet & iConfig):
+  conditions_(SiStripConditionsContext::Topology | SiStripConditionsContext::Geometry)
 {
   //now do what ever initialization is needed
   parameters_ = iConfig;
@@ -31,6 +33,19 @@ SiStripMonitorMuonHLT::SiStripMonitorMuonHLT (const edm::ParameterSet & iConfig)
   printNormalize_ = parameters_.getUntrackedParameter<bool>("printNormalize",false);
   monitorName_ = parameters_.getUntrackedParameter<std::string>("monitorName","HLT/HLTMonMuon");
   prescaleEvt_ = parameters_.getUntrackedParameter<int>("prescaleEvt",-1);
+  counterEvt_ = 0;
+  counterPrescaled_ = 0;
+  nTrig_ = 0;
+  timeBudget_ = parameters_.getUntrackedParameter<double>("timeBudget",-1.);
+  maxPrescale_ = std::max(1, parameters_.getUntrackedParameter<int>("maxAdaptivePrescale",1000));
+  adaptivePrescale_ = 1;
+  costL3Mu_ = -1.;
+  costOptional_ = -1.;
+  lumiEvents_ = 0;
+  lumiOptionalEvents_ = 0;
+  lumiTime_ = 0.;
+  effectivePrescaleME_ = 0;
+  meanTimeME_ = 0;
 
   //booleans
   runOnClusters_ = parameters_.getUntrackedParameter<bool>("runOnClusters",true);
@@ -41,9 +56,13 @@ SiStripMonitorMuonHLT::SiStripMonitorMuonHLT (const edm::ParameterSet & iConfig)
   clusterCollectionTag_ = parameters_.getUntrackedParameter < edm::InputTag > ("clusterCollectionTag",edm::InputTag("hltSiStripRawToClustersFacility"));
   l3collectionTag_ = parameters_.getUntrackedParameter < edm::InputTag > ("l3MuonTag",edm::InputTag("hltL3MuonCandidates"));
   TrackCollectionTag_ = parameters_.getUntrackedParameter < edm::InputTag > ("trackCollectionTag",edm::InputTag("hltL3TkTracksFromL2"));
+  clusterFeaturesTag_ = parameters_.getUntrackedParameter < edm::InputTag > ("clusterFeaturesTag",edm::InputTag(""));
+  featuresSourceLogged_ = false;
   //////////////////////////
 
   HistoNumber = 35;
+  LayerMEMap.resize (HistoNumber);
+  LayerNormMap.resize (HistoNumber);
 
   //services
   dbe_ = 0;
@@ -90,22 +109,26 @@ SiStripMonitorMuonHLT::~SiStripMonitorMuonHLT ()
 // member functions
 //
 
-float SiStripMonitorMuonHLT::GetEtaWeight(std::string label, GlobalPoint clustgp){
+float SiStripMonitorMuonHLT::GetEtaWeight(int layer, float eta){
         float etaWeight = 1.;
-	for (unsigned int i = 0; i < m_BinEta[label].size() - 1; i++){                      
-        	if (m_BinEta[label][i] < clustgp.eta() && clustgp.eta() < m_BinEta[label][i+1]){
-                	if (m_ModNormEta[label][i] > 0.1) etaWeight = 1./m_ModNormEta[label][i];
+	const std::vector<float> & binEta = LayerNormMap[layer].BinEta;
+	const std::vector<float> & modNormEta = LayerNormMap[layer].ModNormEta;
+	for (unsigned int i = 0; i + 1 < binEta.size(); i++){                      
+        	if (binEta[i] < eta && eta < binEta[i+1]){
+                	if (modNormEta[i] > 0.1) etaWeight = 1./modNormEta[i];
                 	else etaWeight = 1.;
               	}       
         }
 	return etaWeight; 
 }
 
-float SiStripMonitorMuonHLT::GetPhiWeight(std::string label, GlobalPoint clustgp){
+float SiStripMonitorMuonHLT::GetPhiWeight(int layer, float phi){
         float phiWeight = 1.;
-	for (unsigned int i = 0; i < m_BinPhi[label].size() - 1; i++){                      
-        	if (m_BinPhi[label][i] < clustgp.phi() && clustgp.phi() < m_BinPhi[label][i+1]){
-                	if (m_ModNormPhi[label][i] > 0.1) phiWeight = 1./m_ModNormPhi[label][i];
+	const std::vector<float> & binPhi = LayerNormMap[layer].BinPhi;
+	const std::vector<float> & modNormPhi = LayerNormMap[layer].ModNormPhi;
+	for (unsigned int i = 0; i + 1 < binPhi.size(); i++){                      
+        	if (binPhi[i] < phi && phi < binPhi[i+1]){
+                	if (modNormPhi[i] > 0.1) phiWeight = 1./modNormPhi[i];
                 	else phiWeight = 1.;
               	}       
         }
@@ -133,13 +156,12 @@ SiStripMonitorMuonHLT::analyze (const edm::Event & iEvent, const edm::EventSetup
   counterEvt_++;
   if (prescaleEvt_ > 0 && counterEvt_ % prescaleEvt_ != 0)
     return;
+  counterPrescaled_++;
   LogDebug ("SiStripMonitorHLTMuon") << " processing conterEvt_: " << counterEvt_ << std::endl;
 
 
-  edm::ESHandle < TrackerGeometry > TG;
-  iSetup.get < TrackerDigiGeometryRecord > ().get (TG);
-  const TrackerGeometry *theTrackerGeometry = TG.product ();
-  const TrackerGeometry & theTracker (*theTrackerGeometry);
+  conditions_.update (iSetup);
+  const TrackerGeometry & theTracker (*conditions_.geometry ());
 
 
   ///////////////////  Access to data   /////////////////////
@@ -161,37 +183,77 @@ SiStripMonitorMuonHLT::analyze (const edm::Event & iEvent, const edm::EventSetup
   bool accessToTracks = true;
   iEvent.getByLabel (TrackCollectionTag_, trackCollection);
   reco::TrackCollection::const_iterator track;
+
+  //Access to the shared cluster features (SiStripClusterFeatureProducer)
+  edm::Handle < SiStripClusterFeatures > clusterFeatures;
+  if (!clusterFeaturesTag_.label ().empty ()) iEvent.getByLabel (clusterFeaturesTag_, clusterFeatures);
    /////////////////////////////////////////////////////
 
+  //the table is made from a DetSetVector and clusterCollectionTag_ is a LazyGetter, so unlike
+  //SiStripMonitorTrack the product ids cannot be compared: the source of the table is logged
+  if (runOnClusters_ && clusterFeatures.isValid () && !featuresSourceLogged_)
+    {
+      featuresSourceLogged_ = true;
+      edm::Provenance features = iEvent.getProvenance (clusterFeatures->clusterProductID);
+      edm::LogInfo ("SiStripMonitorHLTMuon") << "all-clusters plots filled from " << clusterFeaturesTag_.encode ()
+					     << ", made from the clusters of " << features.moduleLabel ()
+					     << ", instead of " << clusterCollectionTag_.encode ()
+					     << ": both must hold the same clusters";
+    }
 
-  if (runOnClusters_ && accessToClusters && !clusters.failedToGet () && clusters.isValid())
+  //the all-clusters and track parts follow the adaptive prescale, the L3 muons are always done;
+  //counted on the events past the static prescale, which would alias with it on counterEvt_
+  bool runOptional = timeBudget_ <= 0. || counterPrescaled_ % adaptivePrescale_ == 0;
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now ();
+
+  if (runOptional && runOnClusters_ && clusterFeatures.isValid ())
+    {
+      // eta/phi already computed per cluster, layer and module index looked up once per module
+      const SiStripClusterFeatures & features = *clusterFeatures;
+      for (unsigned int idet = 0; idet < features.nDets (); ++idet)
+	{
+	  uint detID = features.detIds[idet];
+	  unsigned int first = features.detOffsets[idet];
+	  unsigned int last = features.detOffsets[idet+1];
+	  int layer = tkdetmap_->FindLayer (detID);
+	  LayerMEs * layerMEs = getLayerMEs (layer);
+	  if (layerMEs == 0) continue;
+	  for (unsigned int row = first; row < last; ++row)
+	    {
+	      fillClusterMEs<AllClusters> (*layerMEs, layer, features.eta[row], features.phi[row]);
+	    }
+	  if (last > first) addToTkHistoMap (tkmapAllClustersAcc_, tkmapAllClusters, moduleIndex (detID), detID, last - first);
+	}
+    }
+  else if (runOptional && runOnClusters_ && accessToClusters && !clusters.failedToGet () && clusters.isValid())
     {
+      //the clusters of a module are consecutive: module index looked up once per module
+      uint32_t lastDetID = 0;
+      uint32_t index = SiStripTkHistoMapAccumulator::invalidIndex;
       for (clust = clusters->begin_record (); clust != clusters->end_record (); ++clust)
 	{
 	  
 	  uint detID = clust->geographicalId ();
-	  std::stringstream ss;
 	  int layer = tkdetmap_->FindLayer (detID);
-	  std::string label = tkdetmap_->getLayerName (layer);
-	  const StripGeomDetUnit *theGeomDet = dynamic_cast < const StripGeomDetUnit * >(theTracker.idToDet (detID));
-	  const StripTopology *topol = dynamic_cast < const StripTopology * >(&(theGeomDet->specificTopology ()));
+	  LayerMEs * layerMEs = getLayerMEs (layer);
+	  if (layerMEs == 0) continue;
+	  //strip layers only, so the DetUnit is a StripGeomDetUnit
+	  const StripGeomDetUnit *theGeomDet = static_cast < const StripGeomDetUnit * >(theTracker.idToDetUnit (detID));
+	  if (theGeomDet == 0) continue;
 	  // get the cluster position in local coordinates (cm) 
-	  LocalPoint clustlp = topol->localPosition (clust->barycenter ());
+	  LocalPoint clustlp = theGeomDet->specificTopology ().localPosition (clust->barycenter ());
 	  GlobalPoint clustgp = theGeomDet->surface ().toGlobal (clustlp);
-	  
-	  //NORMALIZE HISTO IF ASKED
-          float etaWeight = 1.;
-          float phiWeight = 1.;
-          if (normalize_){
-	  	etaWeight = GetEtaWeight(label, clustgp);
-	  	phiWeight = GetPhiWeight(label,clustgp);
-          }        
-          LayerMEMap[label.c_str ()].EtaDistribAllClustersMap->Fill (clustgp.eta (),etaWeight);
-          LayerMEMap[label.c_str ()].PhiDistribAllClustersMap->Fill (clustgp.phi (),phiWeight);
-          LayerMEMap[label.c_str ()].EtaPhiAllClustersMap->Fill (clustgp.eta (), clustgp.phi ());
-	  tkmapAllClusters->add(detID,1.);
+	  fillClusterMEs<AllClusters> (*layerMEs, layer, clustgp.eta (), clustgp.phi ());
+	  if (detID != lastDetID)
+	    {
+	      lastDetID = detID;
+	      index = moduleIndex (detID);
+	    }
+	  addToTkHistoMap (tkmapAllClustersAcc_, tkmapAllClusters, index, detID, 1);
 	}
     }
+  Clock::time_point endClusters = Clock::now ();
 
   if (runOnMuonCandidates_ && accessToL3Muons && !l3mucands.failedToGet () && l3mucands.isValid())
     {
@@ -202,240 +264,130 @@ SiStripMonitorMuonHLT::analyze (const edm::Event & iEvent, const edm::EventSetup
 	  analyzeOnTrackClusters(l3tk, theTracker, true);	
 	}			//loop over l3mucands
     }				//if l3seed
+  Clock::time_point endL3Mu = Clock::now ();
  
-  if (runOnTracks_ && accessToTracks && !trackCollection.failedToGet() && trackCollection.isValid()){
+  if (runOptional && runOnTracks_ && accessToTracks && !trackCollection.failedToGet() && trackCollection.isValid()){
 	for (track = trackCollection->begin (); track != trackCollection->end() ; ++ track)
 	  {
 	    const reco::Track* tk =  &(*track);
 	    analyzeOnTrackClusters(tk, theTracker, false);	
 	  }
   }
+  Clock::time_point end = Clock::now ();
+
+  typedef std::chrono::duration<double, std::micro> Microseconds;
+  double optionalTime = Microseconds (endClusters - start).count () + Microseconds (end - endL3Mu).count ();
+  double l3MuTime = Microseconds (endL3Mu - endClusters).count ();
+  ++lumiEvents_;
+  if (runOptional) ++lumiOptionalEvents_;
+  lumiTime_ += optionalTime + l3MuTime;
+  if (timeBudget_ > 0.) updateAdaptivePrescale (optionalTime, l3MuTime, runOptional);
+}
+
+//------------------------------------------------------------------------
+// running means of the two costs; the optional parts are run once every N events with
+// N the smallest prescale for which costL3Mu + costOptional/N fits in the budget
+void SiStripMonitorMuonHLT::updateAdaptivePrescale (double optionalTime, double l3MuTime, bool optionalDone)
+{
+  const double alpha = 0.05;
+  costL3Mu_ = costL3Mu_ < 0. ? l3MuTime : costL3Mu_ + alpha * (l3MuTime - costL3Mu_);
+  if (optionalDone)
+    costOptional_ = costOptional_ < 0. ? optionalTime : costOptional_ + alpha * (optionalTime - costOptional_);
+
+  double spare = timeBudget_ - costL3Mu_;
+  if (spare <= 0.) adaptivePrescale_ = maxPrescale_;
+  else adaptivePrescale_ = std::max (1, std::min (maxPrescale_, int (std::ceil (costOptional_ / spare))));
+  LogDebug ("SiStripMonitorHLTMuon") << " L3 muon cost " << costL3Mu_ << " us, optional cost " << costOptional_
+				     << " us, adaptive prescale " << adaptivePrescale_ << std::endl;
+}
+
+//------------------------------------------------------------------------
+// prescale of the all-clusters and track parts over the lumi section, static one included
+void SiStripMonitorMuonHLT::endLuminosityBlock (const edm::LuminosityBlock & lumi, const edm::EventSetup & es)
+{
+  tkmapAllClustersAcc_.flush (tkmapAllClusters);
+  tkmapOnTrackClustersAcc_.flush (tkmapOnTrackClusters);
+  tkmapL3MuTrackClustersAcc_.flush (tkmapL3MuTrackClusters);
+
+  if (lumiEvents_ > 0)
+    {
+      double prescale = (prescaleEvt_ > 0 ? prescaleEvt_ : 1) * (lumiOptionalEvents_ > 0 ? double (lumiEvents_) / lumiOptionalEvents_ : double (lumiEvents_));
+      if (effectivePrescaleME_) effectivePrescaleME_->Fill (prescale);
+      if (meanTimeME_) meanTimeME_->Fill (lumiTime_ / lumiEvents_);
+      edm::LogInfo ("SiStripMonitorHLTMuon") << "lumi " << lumi.id ().luminosityBlock () << ": effective prescale " << prescale
+					     << ", mean time " << lumiTime_ / lumiEvents_ << " us per event";
+    }
+  lumiEvents_ = 0;
+  lumiOptionalEvents_ = 0;
+  lumiTime_ = 0.;
+}
 
+//------------------------------------------------------------------------
+// one array increment for the strip modules of the geometry, TkHistoMap::add otherwise
+void SiStripMonitorMuonHLT::addToTkHistoMap (SiStripTkHistoMapAccumulator & acc, TkHistoMap * map, uint32_t index, uint32_t detid, uint32_t n)
+{
+  if (index != SiStripTkHistoMapAccumulator::invalidIndex) acc.add (index, n);
+  else map->add (detid, float (n));
 }
 
 void SiStripMonitorMuonHLT::analyzeOnTrackClusters( const reco::Track* l3tk, const TrackerGeometry & theTracker,  bool isL3MuTrack ){
 
-	  for (size_t hit = 0; hit < l3tk->recHitsSize (); hit++)
+  for (trackingRecHit_iterator ihit = l3tk->recHitsBegin (); ihit != l3tk->recHitsEnd (); ++ihit)
+    {
+      //one call per strip cluster of the hit, mono and stereo for matched hits
+      visitStripHit (**ihit, theTracker, [&] (const SiStripHitCluster & c)
+	{
+	  int layer = tkdetmap_->FindLayer (c.detid);
+	  LayerMEs * layerMEs = getLayerMEs (layer);
+	  if (layerMEs == 0) return;
+	  uint32_t index = moduleIndex (c.detid);
+	  const StripGeomDetUnit *theGeomDet = static_cast < const StripGeomDetUnit * >(c.unit);
+	  // get the cluster position in local coordinates (cm) 
+	  LocalPoint clustlp = theGeomDet->specificTopology ().localPosition (c.cluster->barycenter ());
+	  GlobalPoint clustgp = theGeomDet->surface ().toGlobal (clustlp);
+	  if (isL3MuTrack)
+	    {
+	      fillClusterMEs<L3MuTrackClusters> (*layerMEs, layer, clustgp.eta (), clustgp.phi ());
+	      addToTkHistoMap (tkmapL3MuTrackClustersAcc_, tkmapL3MuTrackClusters, index, c.detid, 1);
+	    }
+	  else
 	    {
-	      //if hit is valid and in tracker say true
-	      if (l3tk->recHit (hit)->isValid () == true && l3tk->recHit (hit)->geographicalId ().det () == DetId::Tracker)
-		{
-		  uint detID = l3tk->recHit (hit)->geographicalId ()();
-		  
-		  const SiStripRecHit1D *hit1D = dynamic_cast < const SiStripRecHit1D * >(l3tk->recHit (hit).get ());
-		  const SiStripRecHit2D *hit2D = dynamic_cast < const SiStripRecHit2D * >(l3tk->recHit (hit).get ());
-		  const SiStripMatchedRecHit2D *hitMatched2D = dynamic_cast < const SiStripMatchedRecHit2D * >(l3tk->recHit (hit).get ());
-		  const ProjectedSiStripRecHit2D *hitProj2D = dynamic_cast < const ProjectedSiStripRecHit2D * >(l3tk->recHit (hit).get ());
-
-
-		  // if SiStripRecHit1D
-		  if (hit1D != 0)
-		    {
-		      if (hit1D->cluster_regional ().isNonnull ())
-			{
-			  if (hit1D->cluster_regional ().isAvailable ())
-			    {
-			      detID = hit1D->cluster_regional ()->geographicalId ();
-			    }
-			}
-		      int layer = tkdetmap_->FindLayer (detID);
-		      std::string label = tkdetmap_->getLayerName (layer);
-		      const StripGeomDetUnit *theGeomDet = dynamic_cast < const StripGeomDetUnit * >(theTracker.idToDet (detID));
-		      if (theGeomDet != 0)
-			{
-			  const StripTopology *topol = dynamic_cast < const StripTopology * >(&(theGeomDet->specificTopology ()));
-			  if (topol != 0)
-			    {
-			      // get the cluster position in local coordinates (cm) 
-			      LocalPoint clustlp = topol->localPosition (hit1D->cluster_regional ()->barycenter ());
-			      GlobalPoint clustgp = theGeomDet->surface ().toGlobal (clustlp);
-			      //NORMALIZE HISTO IF ASKED
-			      float etaWeight = 1.;
-          		      float phiWeight = 1.;
-          		      if (normalize_){
-	  			etaWeight = GetEtaWeight(label, clustgp);
-	  			phiWeight = GetPhiWeight(label,clustgp);
-   			      }        
-			      if(!isL3MuTrack){
-                              	LayerMEMap[label.c_str ()].EtaDistribOnTrackClustersMap->Fill (clustgp.eta (),etaWeight);
-                              	LayerMEMap[label.c_str ()].PhiDistribOnTrackClustersMap->Fill (clustgp.phi (),phiWeight);
-                              	LayerMEMap[label.c_str ()].EtaPhiOnTrackClustersMap->Fill (clustgp.eta (), clustgp.phi ());  
-	  			tkmapOnTrackClusters->add(detID,1.);
-			      }
-			      else{
-                              	LayerMEMap[label.c_str ()].EtaDistribL3MuTrackClustersMap->Fill (clustgp.eta (),etaWeight);
-                              	LayerMEMap[label.c_str ()].PhiDistribL3MuTrackClustersMap->Fill (clustgp.phi (),phiWeight);
-                              	LayerMEMap[label.c_str ()].EtaPhiL3MuTrackClustersMap->Fill (clustgp.eta (), clustgp.phi ());  
-	  			tkmapL3MuTrackClusters->add(detID,1.);
-			      }
-			    }
-			}
-		    }
-		  // if SiStripRecHit2D
-		  if (hit2D != 0)
-		    {
-		      if (hit2D->cluster_regional ().isNonnull ())
-			{
-			  if (hit2D->cluster_regional ().isAvailable ())
-			    {
-			      detID = hit2D->cluster_regional ()->geographicalId ();
-			    }
-			}
-		      int layer = tkdetmap_->FindLayer (detID);
-		      std::string label = tkdetmap_->getLayerName (layer);
-		      const StripGeomDetUnit *theGeomDet = dynamic_cast < const StripGeomDetUnit * >(theTracker.idToDet (detID));
-		      if (theGeomDet != 0)
-			{
-			  const StripTopology *topol = dynamic_cast < const StripTopology * >(&(theGeomDet->specificTopology ()));
-			  if (topol != 0)
-			    {
-			      // get the cluster position in local coordinates (cm) 
-			      LocalPoint clustlp = topol->localPosition (hit2D->cluster_regional ()->barycenter ());
-			      GlobalPoint clustgp = theGeomDet->surface ().toGlobal (clustlp);
-	  		      
-			      //NORMALIZE HISTO IF ASKED
-			      float etaWeight = 1.;
-          		      float phiWeight = 1.;
-          		      if (normalize_){
-	  			etaWeight = GetEtaWeight(label, clustgp);
-	  			phiWeight = GetPhiWeight(label,clustgp);
-   			      }
-			      if(!isL3MuTrack){
-                              	LayerMEMap[label.c_str ()].EtaDistribOnTrackClustersMap->Fill (clustgp.eta (),etaWeight);
-                              	LayerMEMap[label.c_str ()].PhiDistribOnTrackClustersMap->Fill (clustgp.phi (),phiWeight);
-                              	LayerMEMap[label.c_str ()].EtaPhiOnTrackClustersMap->Fill (clustgp.eta (), clustgp.phi ());  
-	  			tkmapOnTrackClusters->add(detID,1.);
-			      }
-			      else{
-                              	LayerMEMap[label.c_str ()].EtaDistribL3MuTrackClustersMap->Fill (clustgp.eta (),etaWeight);
-                              	LayerMEMap[label.c_str ()].PhiDistribL3MuTrackClustersMap->Fill (clustgp.phi (),phiWeight);
-                              	LayerMEMap[label.c_str ()].EtaPhiL3MuTrackClustersMap->Fill (clustgp.eta (), clustgp.phi ());  
-	  			tkmapL3MuTrackClusters->add(detID,1.);
-			      }
-			    }
-			}
-		    }
-		  // if SiStripMatchedRecHit2D  
-		  if (hitMatched2D != 0)
-		    {
-		      //hit mono
-	              detID = hitMatched2D->monoCluster().geographicalId ();
-		      int layer = tkdetmap_->FindLayer (detID);
-		      std::string label = tkdetmap_->getLayerName (layer);
-		      const StripGeomDetUnit *theGeomDet = dynamic_cast < const StripGeomDetUnit * >(theTracker.idToDet (detID));
-		      if (theGeomDet != 0)
-			{
-			  const StripTopology *topol = dynamic_cast < const StripTopology * >(&(theGeomDet->specificTopology ()));
-			  if (topol != 0)
-			    {
-			      // get the cluster position in local coordinates (cm) 
-			      LocalPoint clustlp = topol->localPosition (hitMatched2D->monoCluster().barycenter ());
-			      GlobalPoint clustgp = theGeomDet->surface ().toGlobal (clustlp);
-			      //NORMALIZE HISTO IF ASKED
-			      float etaWeight = 1.;
-          		      float phiWeight = 1.;
-          		      if (normalize_){
-	  			etaWeight = GetEtaWeight(label, clustgp);
-	  			phiWeight = GetPhiWeight(label,clustgp);
-   			      }        
-			      if(!isL3MuTrack){
-                              	LayerMEMap[label.c_str ()].EtaDistribOnTrackClustersMap->Fill (clustgp.eta (),etaWeight);
-                              	LayerMEMap[label.c_str ()].PhiDistribOnTrackClustersMap->Fill (clustgp.phi (),phiWeight);
-                              	LayerMEMap[label.c_str ()].EtaPhiOnTrackClustersMap->Fill (clustgp.eta (), clustgp.phi ());  
-	  			tkmapOnTrackClusters->add(detID,1.);
-			      }
-			      else{
-                              	LayerMEMap[label.c_str ()].EtaDistribL3MuTrackClustersMap->Fill (clustgp.eta (),etaWeight);
-                              	LayerMEMap[label.c_str ()].PhiDistribL3MuTrackClustersMap->Fill (clustgp.phi (),phiWeight);
-                              	LayerMEMap[label.c_str ()].EtaPhiL3MuTrackClustersMap->Fill (clustgp.eta (), clustgp.phi ());  
-	  			tkmapL3MuTrackClusters->add(detID,1.);
-			      }
-			    }
-			}
-
-		      //hit stereo
-	              detID = hitMatched2D->stereoCluster().geographicalId ();
-		      layer = tkdetmap_->FindLayer (detID);
-		      label = tkdetmap_->getLayerName (layer);
-		      const StripGeomDetUnit *theGeomDet2 = dynamic_cast < const StripGeomDetUnit * >(theTracker.idToDet (detID));
-		      if (theGeomDet2 != 0)
-			{
-			  const StripTopology *topol = dynamic_cast < const StripTopology * >(&(theGeomDet2->specificTopology ()));
-			  if (topol != 0)
-			    {
-			      // get the cluster position in local coordinates (cm) 
-			      LocalPoint clustlp = topol->localPosition (hitMatched2D->stereoCluster().barycenter ());
-			      GlobalPoint clustgp = theGeomDet2->surface ().toGlobal (clustlp);
-			      //NORMALIZE HISTO IF ASKED
-			      float etaWeight = 1.;
-          		      float phiWeight = 1.;
-          		      if (normalize_){
-	  			etaWeight = GetEtaWeight(label, clustgp);
-	  			phiWeight = GetPhiWeight(label,clustgp);
-   			      }        
-			      if(!isL3MuTrack){
-                              	LayerMEMap[label.c_str ()].EtaDistribOnTrackClustersMap->Fill (clustgp.eta (),etaWeight);
-                              	LayerMEMap[label.c_str ()].PhiDistribOnTrackClustersMap->Fill (clustgp.phi (),phiWeight);
-                              	LayerMEMap[label.c_str ()].EtaPhiOnTrackClustersMap->Fill (clustgp.eta (), clustgp.phi ());  
-	  			tkmapOnTrackClusters->add(detID,1.);
-			      }
-			      else{
-                              	LayerMEMap[label.c_str ()].EtaDistribL3MuTrackClustersMap->Fill (clustgp.eta (),etaWeight);
-                              	LayerMEMap[label.c_str ()].PhiDistribL3MuTrackClustersMap->Fill (clustgp.phi (),phiWeight);
-                              	LayerMEMap[label.c_str ()].EtaPhiL3MuTrackClustersMap->Fill (clustgp.eta (), clustgp.phi ());  
-	  			tkmapL3MuTrackClusters->add(detID,1.);
-			      }
-			    }
-			}
-
-		    }
-
-		  //if ProjectedSiStripRecHit2D
-		  if (hitProj2D != 0)
-		    {
-		      if (hitProj2D->originalHit ().cluster_regional ().isNonnull ())
-			{
-			  if (hitProj2D->originalHit ().cluster_regional ().isAvailable ())
-			    {
-			      detID = hitProj2D->originalHit ().cluster_regional ()->geographicalId ();
-			    }
-			}
-		      int layer = tkdetmap_->FindLayer (detID);
-		      std::string label = tkdetmap_->getLayerName (layer);
-		      const StripGeomDetUnit *theGeomDet = dynamic_cast < const StripGeomDetUnit * >(theTracker.idToDet (detID));
-		      if (theGeomDet != 0)
-			{
-			  const StripTopology *topol = dynamic_cast < const StripTopology * >(&(theGeomDet->specificTopology ()));
-			  if (topol != 0)
-			    {
-			      // get the cluster position in local coordinates (cm) 
-			      LocalPoint clustlp = topol->localPosition (hitProj2D->originalHit ().cluster_regional ()->barycenter ());
-			      GlobalPoint clustgp = theGeomDet->surface ().toGlobal (clustlp);
-			      //NORMALIZE HISTO IF ASKED
-			      float etaWeight = 1.;
-          		      float phiWeight = 1.;
-          		      if (normalize_){
-	  			etaWeight = GetEtaWeight(label, clustgp);
-	  			phiWeight = GetPhiWeight(label,clustgp);
-   			      }        
-			      if(!isL3MuTrack){
-                              	LayerMEMap[label.c_str ()].EtaDistribOnTrackClustersMap->Fill (clustgp.eta (),etaWeight);
-                              	LayerMEMap[label.c_str ()].PhiDistribOnTrackClustersMap->Fill (clustgp.phi (),phiWeight);
-                              	LayerMEMap[label.c_str ()].EtaPhiOnTrackClustersMap->Fill (clustgp.eta (), clustgp.phi ());  
-	  			tkmapOnTrackClusters->add(detID,1.);
-			      }
-			      else{
-                              	LayerMEMap[label.c_str ()].EtaDistribL3MuTrackClustersMap->Fill (clustgp.eta (),etaWeight);
-                              	LayerMEMap[label.c_str ()].PhiDistribL3MuTrackClustersMap->Fill (clustgp.phi (),phiWeight);
-                              	LayerMEMap[label.c_str ()].EtaPhiL3MuTrackClustersMap->Fill (clustgp.eta (), clustgp.phi ());  
-	  			tkmapL3MuTrackClusters->add(detID,1.);
-			      }
-			    }
-			}
-		    }
-
-		}
-	    }			//loop over RecHits
+	      fillClusterMEs<OnTrackClusters> (*layerMEs, layer, clustgp.eta (), clustgp.phi ());
+	      addToTkHistoMap (tkmapOnTrackClustersAcc_, tkmapOnTrackClusters, index, c.detid, 1);
+	    }
+	});
+    }			//loop over RecHits
+}
+
+//------------------------------------------------------------------------
+// eta, phi and eta-phi of one cluster in the MEs of set, normalised if asked
+template <SiStripMonitorMuonHLT::ClusterSet set>
+void SiStripMonitorMuonHLT::fillClusterMEs (LayerMEs & layerMEs, int layer, float eta, float phi)
+{
+  float etaWeight = 1.;
+  float phiWeight = 1.;
+  if (normalize_){
+    etaWeight = GetEtaWeight(layer, eta);
+    phiWeight = GetPhiWeight(layer, phi);
+  }
+  switch (set)
+    {
+    case AllClusters:
+      layerMEs.EtaDistribAllClustersMap->Fill (eta,etaWeight);
+      layerMEs.PhiDistribAllClustersMap->Fill (phi,phiWeight);
+      layerMEs.EtaPhiAllClustersMap->Fill (eta, phi);
+      break;
+    case OnTrackClusters:
+      layerMEs.EtaDistribOnTrackClustersMap->Fill (eta,etaWeight);
+      layerMEs.PhiDistribOnTrackClustersMap->Fill (phi,phiWeight);
+      layerMEs.EtaPhiOnTrackClustersMap->Fill (eta, phi);
+      break;
+    case L3MuTrackClusters:
+      layerMEs.EtaDistribL3MuTrackClustersMap->Fill (eta,etaWeight);
+      layerMEs.PhiDistribL3MuTrackClustersMap->Fill (phi,phiWeight);
+      layerMEs.EtaPhiL3MuTrackClustersMap->Fill (eta, phi);
+      break;
+    }
 }
 
 void
@@ -463,10 +415,8 @@ SiStripMonitorMuonHLT::createMEs (const edm::EventSetup & es)
   //----------------
 
   //Get the tracker geometry
-  edm::ESHandle < TrackerGeometry > TG;
-  es.get < TrackerDigiGeometryRecord > ().get (TG);
-  const TrackerGeometry *theTrackerGeometry = TG.product ();
-  const TrackerGeometry & theTracker (*theTrackerGeometry);
+  conditions_.update (es);
+  const TrackerGeometry & theTracker (*conditions_.geometry ());
 
   std::vector<DetId> Dets = theTracker.detUnitIds();  
 
@@ -609,23 +559,23 @@ SiStripMonitorMuonHLT::createMEs (const edm::EventSetup & es)
       	title = "#eta-#phi L3MuTrack Clusters map in " + labelHisto;
       	layerMEs.EtaPhiL3MuTrackClustersMap = dbe_->book2D (histoname, title, sizeEta - 1, xbinsEta, sizePhi - 1, xbinsPhi);
       }
-      LayerMEMap[labelHisto] = layerMEs;
+      LayerMEMap[layer] = layerMEs;
 
       //PUTTING ERRORS
       if(runOnClusters_){
-      	LayerMEMap[labelHisto].EtaDistribAllClustersMap->getTH1F()->Sumw2();
-     	LayerMEMap[labelHisto].PhiDistribAllClustersMap->getTH1F()->Sumw2();
-      	LayerMEMap[labelHisto].EtaPhiAllClustersMap->getTH2F()->Sumw2();
+      	LayerMEMap[layer].EtaDistribAllClustersMap->getTH1F()->Sumw2();
+     	LayerMEMap[layer].PhiDistribAllClustersMap->getTH1F()->Sumw2();
+      	LayerMEMap[layer].EtaPhiAllClustersMap->getTH2F()->Sumw2();
       }
       if(runOnTracks_){
-      	LayerMEMap[labelHisto].EtaDistribOnTrackClustersMap->getTH1F()->Sumw2();
-      	LayerMEMap[labelHisto].PhiDistribOnTrackClustersMap->getTH1F()->Sumw2();
-      	LayerMEMap[labelHisto].EtaPhiOnTrackClustersMap->getTH2F()->Sumw2();
+      	LayerMEMap[layer].EtaDistribOnTrackClustersMap->getTH1F()->Sumw2();
+      	LayerMEMap[layer].PhiDistribOnTrackClustersMap->getTH1F()->Sumw2();
+      	LayerMEMap[layer].EtaPhiOnTrackClustersMap->getTH2F()->Sumw2();
       }
       if(runOnMuonCandidates_){
-      	LayerMEMap[labelHisto].EtaDistribL3MuTrackClustersMap->getTH1F()->Sumw2();
-      	LayerMEMap[labelHisto].PhiDistribL3MuTrackClustersMap->getTH1F()->Sumw2();
-     	LayerMEMap[labelHisto].EtaPhiL3MuTrackClustersMap->getTH2F()->Sumw2();
+      	LayerMEMap[layer].EtaDistribL3MuTrackClustersMap->getTH1F()->Sumw2();
+      	LayerMEMap[layer].PhiDistribL3MuTrackClustersMap->getTH1F()->Sumw2();
+     	LayerMEMap[layer].EtaPhiL3MuTrackClustersMap->getTH2F()->Sumw2();
       }
       
       p++;
@@ -635,6 +585,16 @@ SiStripMonitorMuonHLT::createMEs (const edm::EventSetup & es)
   //CALL THE NORMALIZATION METHOD
   Normalizer(Dets,theTracker);
 
+  //COPY THE NORMALISATION PER LAYER NUMBER, THE LABELS ARE NOT USED AFTER BOOKING
+  for (int layer = 1; layer < HistoNumber; ++layer)
+    {
+      std::string labelHisto = tkdetmap_->getLayerName (layer);
+      LayerNormMap[layer].BinEta = m_BinEta[labelHisto];
+      LayerNormMap[layer].BinPhi = m_BinPhi[labelHisto];
+      LayerNormMap[layer].ModNormEta = m_ModNormEta[labelHisto];
+      LayerNormMap[layer].ModNormPhi = m_ModNormPhi[labelHisto];
+    }
+
 }				//end of method
 
 
@@ -643,9 +603,7 @@ SiStripMonitorMuonHLT::GeometryFromTrackGeom (std::vector<DetId> Dets,const Trac
                                               std::map< std::string,std::vector<float> > & m_PhiStripMod_Eta,std::map< std::string,std::vector<float> > & m_PhiStripMod_Nb){
 
   //Retrieve tracker topology from geometry
-  edm::ESHandle<TrackerTopology> tTopoHandle;
-  es.get<IdealGeometryRecord>().get(tTopoHandle);
-  const TrackerTopology* const tTopo = tTopoHandle.product();
+  const TrackerTopology* const tTopo = conditions_.topology();
 
   std::vector<std::string> v_LabelHisto;
 
@@ -1300,6 +1258,22 @@ SiStripMonitorMuonHLT::beginRun (const edm::Run& run, const edm::EventSetup & es
       	tkmapOnTrackClusters = new TkHistoMap("HLT/HLTMonMuon/SiStrip" ,"TkHMap_OnTrackClusters",0.0,0);
       if(runOnMuonCandidates_)
       	tkmapL3MuTrackClusters = new TkHistoMap("HLT/HLTMonMuon/SiStrip" ,"TkHMap_L3MuTrackClusters",0.0,0);
+      //strip modules of the geometry, index of the per-module counts
+      std::vector<uint32_t> stripDetIds;
+      const std::vector<DetId>& dets = conditions_.geometry ()->detUnitIds ();
+      for (std::vector<DetId>::const_iterator det = dets.begin (); det != dets.end (); ++det)
+	if (det->subdetId () >= StripSubdetector::TIB) stripDetIds.push_back (det->rawId ());
+      tkmapAllClustersAcc_.setModules (stripDetIds);
+      tkmapOnTrackClustersAcc_.setModules (stripDetIds);
+      tkmapL3MuTrackClustersAcc_.setModules (stripDetIds);
+      if(timeBudget_ > 0.){
+	dbe_->setCurrentFolder (monitorName_ + "SiStrip");
+	//one value per lumi section: saved per lumi rather than overwritten
+	effectivePrescaleME_ = dbe_->bookFloat ("EffectivePrescale");
+	effectivePrescaleME_->setLumiFlag ();
+	meanTimeME_ = dbe_->bookFloat ("MeanTimePerEvent");
+	meanTimeME_->setLumiFlag ();
+      }
     }
 }
 
@@ -0,0 +1,1551 @@
+#include <FWCore/MessageLogger/interface/MessageLogger.h>
+
+#include "Geometry/Records/interface/TrackerDigiGeometryRecord.h"
+#include "Geometry/TrackerGeometryBuilder/interface/GluedGeomDet.h"
+#include "Geometry/TrackerGeometryBuilder/interface/StripGeomDetUnit.h"
+
+#include "CalibTracker/Records/interface/SiStripDetCablingRcd.h"
+#include "DataFormats/SiStripDetId/interface/SiStripSubStructure.h"
+#include "DataFormats/DetId/interface/DetId.h"
+#include "DataFormats/SiStripDetId/interface/StripSubdetector.h"
+#include "DataFormats/TrackerRecHit2D/interface/SiStripRecHit2D.h"
+#include "DataFormats/TrackerRecHit2D/interface/SiStripRecHit1D.h"
+#include "DataFormats/TrackerRecHit2D/interface/ProjectedSiStripRecHit2D.h"
+#include "DataFormats/TrackerRecHit2D/interface/SiStripMatchedRecHit2D.h"
+#include "TrackingTools/TrajectoryState/interface/TrajectoryStateTransform.h"
+#include "TrackingTools/TrajectoryParametrization/interface/GlobalTrajectoryParameters.h"
+#include "TrackingTools/GeomPropagators/interface/HelixArbitraryPlaneCrossing.h"
+#include "MagneticField/Records/interface/IdealMagneticFieldRecord.h"
+#include "CalibTracker/SiStripCommon/interface/SiStripDCSStatus.h"
+#include "CommonTools/TriggerUtils/interface/GenericTriggerEventFlag.h"
+
+#include "DQM/SiStripMonitorTrack/interface/SiStripMonitorTrack.h"
+#include "DQM/SiStripMonitorTrack/interface/SiStripClusterNtupleWriter.h"
+
+#include "DQM/SiStripCommon/interface/SiStripHistoId.h"
+#include "DQM/SiStripCommon/interface/TkDetMap.h"
+#include "DataFormats/SiStripDigi/interface/SiStripRawDigi.h"
+#include "CondFormats/SiStripObjects/interface/SiStripPedestals.h"
+#include "CondFormats/DataRecord/interface/SiStripPedestalsRcd.h"
+#include "TMath.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+SiStripMonitorTrack::SiStripMonitorTrack(const edm::ParameterSet& conf): 
+  dbe(edm::Service<DQMStore>().operator->()),
+  conf_(conf),
+  tkhisto_StoNCorrOnTrack(0),
+  tkhisto_NumOnTrack(0),
+  tkhisto_NumOffTrack(0),
+  booked_(false),
+  currentInput_(0),
+  fillQueue_(conf.getParameter<edm::ParameterSet>("DeferredFills")),
+  onTrackMask_(SiStripArenaAllocator<uint8_t>(eventArena_)),
+  firstCluster_(0),
+  onTrackSlot_(SiStripArenaAllocator<int32_t>(eventArena_)),
+  onTrackClusters_(SiStripArenaAllocator<OnTrackCluster>(eventArena_)),
+  conditions_(SiStripConditionsContext::Topology | SiStripConditionsContext::Geometry | SiStripConditionsContext::Cabling),
+  pendingChanges_(0),
+  hotModuleFinder_(conf.getParameter<edm::ParameterSet>("HotModuleDetection")),
+  HotModules(0),
+  nHotModules(0),
+  moduleStatistics_(conf.getParameter<edm::ParameterSet>("ModuleStatistics")),
+  APVSummary(0),
+  qualityTests_(conf.getParameter<edm::ParameterSet>("QualityTests")),
+  clusterSampler_(conf.getParameter<edm::ParameterSet>("OffTrackSampling")),
+  SamplingFraction(0),
+  vOnTrackStrips(SiStripArenaAllocator<OnTrackStrips>(eventArena_)),
+  tracksCollection_in_EventTree(true),
+  firstEvent(-1),
+  genTriggerEventFlag_(new GenericTriggerEventFlag(conf)),
+  eventFilterCache_(conf.getParameter<edm::ParameterSet>("EventFilterCache"), conf),
+  clusterNtuple_(0),
+  clusterFeatures_(0)
+{
+  Cluster_src_   = conf.getParameter<edm::InputTag>("Cluster_src");
+  ClusterFeatures_ = conf.getParameter<edm::InputTag>("ClusterFeatures");
+  Mod_On_        = conf.getParameter<bool>("Mod_On");
+  APV_On_        = conf.getParameter<bool>("APV_On");
+  Trend_On_      = conf.getParameter<bool>("Trend_On");
+  edm::ParameterSet ParametersTrend = conf_.getParameter<edm::ParameterSet>("Trending");
+  TrendNbins_      = ParametersTrend.getParameter<int32_t>("Nbins");
+  TrendSteps_      = std::max(1, ParametersTrend.getParameter<int32_t>("Steps"));
+  TrendUpdateMode_ = ParametersTrend.getParameter<int32_t>("UpdateMode");
+  flag_ring      = conf.getParameter<bool>("RingFlag_On");
+  TkHistoMap_On_ = conf.getParameter<bool>("TkHistoMap_On");
+  parseBinnings();
+
+  edm::ParameterSet ParametersClustersOn =  conf_.getParameter<edm::ParameterSet>("TH1nClustersOn");
+  layerontrack = ParametersClustersOn.getParameter<bool>("layerswitchon");
+
+  edm::ParameterSet ParametersClustersOff =  conf_.getParameter<edm::ParameterSet>("TH1nClustersOff");
+  layerofftrack = ParametersClustersOff.getParameter<bool>("layerswitchon");
+
+  edm::ParameterSet ParametersClusterCharge =  conf_.getParameter<edm::ParameterSet>("TH1ClusterCharge");
+  layercharge = ParametersClusterCharge.getParameter<bool>("layerswitchon");
+
+  edm::ParameterSet ParametersClusterStoN =  conf_.getParameter<edm::ParameterSet>("TH1ClusterStoN");
+  layerston = ParametersClusterStoN.getParameter<bool>("layerswitchon");
+
+  edm::ParameterSet ParametersClusterChargeCorr =  conf_.getParameter<edm::ParameterSet>("TH1ClusterChargeCorr");
+  layerchargecorr = ParametersClusterChargeCorr.getParameter<bool>("layerswitchon");
+
+  edm::ParameterSet ParametersClusterStoNCorrOn =  conf_.getParameter<edm::ParameterSet>("TH1ClusterStoNCorr");
+  layerstoncorrontrack = ParametersClusterStoNCorrOn.getParameter<bool>("layerswitchon");
+
+  edm::ParameterSet ParametersClusterNoise =  conf_.getParameter<edm::ParameterSet>("TH1ClusterNoise");
+  layernoise = ParametersClusterNoise.getParameter<bool>("layerswitchon");
+
+  edm::ParameterSet ParametersClusterWidth =  conf_.getParameter<edm::ParameterSet>("TH1ClusterWidth");
+  layerwidth = ParametersClusterWidth.getParameter<bool>("layerswitchon");
+
+  ModulesToBeExcluded_ = conf_.getParameter< std::vector<uint32_t> >("ModulesToBeExcluded");
+
+  // quality tests stand for the layer/subdet StoNCorr and Width histograms
+  qualityTests_.setAxisRange(SiStripQualityTests::StoNCorrMean,  binnings_[TH1ClusterStoNCorr].xmin, binnings_[TH1ClusterStoNCorr].xmax);
+  qualityTests_.setAxisRange(SiStripQualityTests::WidthContents, binnings_[TH1ClusterWidth].xmin,    binnings_[TH1ClusterWidth].xmax);
+
+  // module level statistics: same ranges as the module histograms they replace
+  ModStatistics_On_ = Mod_On_ && moduleStatistics_.on();
+  moduleStatistics_.setRange(SiStripModuleStatistics::StoNCorr,   binnings_[TH1ClusterStoNCorrMod].xmin, binnings_[TH1ClusterStoNCorrMod].xmax);
+  moduleStatistics_.setRange(SiStripModuleStatistics::Charge,     binnings_[TH1ClusterCharge].xmin,      binnings_[TH1ClusterCharge].xmax);
+  moduleStatistics_.setRange(SiStripModuleStatistics::ChargeCorr, binnings_[TH1ClusterChargeCorr].xmin,  binnings_[TH1ClusterChargeCorr].xmax);
+  moduleStatistics_.setRange(SiStripModuleStatistics::Width,      binnings_[TH1ClusterWidth].xmin,       binnings_[TH1ClusterWidth].xmax);
+
+  // PGV profile ranges
+  const BinningSpec& pgv = binnings_[TProfileClusterPGV];
+  pgvAccumulator_.setRange(pgv.xmin, pgv.xmax, pgv.ymin, pgv.ymax);
+
+  // raw digi (virgin raw) monitoring
+  RawDigis_On_         = conf_.getParameter<bool>("RawDigis_On");
+  RawDigiProducer_     = conf_.getParameter<std::string>("RawDigiProducer");
+  RawDigiLabel_        = conf_.getParameter<std::string>("RawDigiLabel");
+  RawDigiHitThreshold_ = conf_.getParameter<double>("RawDigiHitThreshold");
+
+  // primary track collection, then the additional ones (one on-track bit each)
+  TrackInput primaryInput;
+  primaryInput.producer          = conf_.getParameter<std::string>("TrackProducer");
+  primaryInput.label             = conf_.getParameter<std::string>("TrackLabel");
+  primaryInput.trajectoryInEvent = conf_.getParameter<bool>("TrajectoryInEvent");
+  trackInputs_.push_back(primaryInput);
+  std::vector<edm::ParameterSet> ParametersTrackInputs = conf_.getParameter<std::vector<edm::ParameterSet> >("TrackInputs");
+  for (std::vector<edm::ParameterSet>::const_iterator iInput = ParametersTrackInputs.begin(); iInput != ParametersTrackInputs.end(); ++iInput) {
+    if (trackInputs_.size() == 8*sizeof(uint8_t)) {
+      edm::LogError("SiStripMonitorTrack") << "Only " << trackInputs_.size() << " track collections can be monitored, the following TrackInputs are ignored" << std::endl;
+      break;
+    }
+    TrackInput input;
+    input.producer          = iInput->getParameter<std::string>("TrackProducer");
+    input.label             = iInput->getParameter<std::string>("TrackLabel");
+    input.trajectoryInEvent = iInput->getParameter<bool>("TrajectoryInEvent");
+    input.suffix            = "_" + iInput->getParameter<std::string>("Tag");
+    trackInputs_.push_back(input);
+  }
+  HelixAngleValidation_ = conf_.getParameter<bool>("HelixAngleValidation");
+  std::string SharedClusters = conf_.getParameter<std::string>("SharedClusters");
+  if (SharedClusters == "FillOnce")          sharedClusters_ = FillOnce;
+  else if (SharedClusters == "FillShared")   sharedClusters_ = FillShared;
+  else {
+    if (SharedClusters != "FillPerTrack")
+      edm::LogError("SiStripMonitorTrack") << "Unknown SharedClusters " << SharedClusters << ", FillPerTrack is used" << std::endl;
+    sharedClusters_ = FillPerTrack;
+  }
+
+  // cluster quality conditions 
+  edm::ParameterSet cluster_condition = conf_.getParameter<edm::ParameterSet>("ClusterConditions");
+  applyClusterQuality_ = cluster_condition.getParameter<bool>("On");
+  sToNLowerLimit_      = cluster_condition.getParameter<double>("minStoN");
+  sToNUpperLimit_      = cluster_condition.getParameter<double>("maxStoN");
+  widthLowerLimit_     = cluster_condition.getParameter<double>("minWidth"); 
+  widthUpperLimit_     = cluster_condition.getParameter<double>("maxWidth"); 
+
+
+  // Create DCS Status
+  bool checkDCS    = conf_.getParameter<bool>("UseDCSFiltering");
+  if (checkDCS) dcsStatus_ = new SiStripDCSStatus();
+  else dcsStatus_ = 0; 
+
+  // optional columnar dump of the per-cluster quantities
+  edm::ParameterSet ParametersClusterNtuple = conf_.getParameter<edm::ParameterSet>("ClusterNtuple");
+  ClusterNtuple_On_ = ParametersClusterNtuple.getParameter<bool>("On");
+  if (ClusterNtuple_On_) clusterNtuple_ = new SiStripClusterNtupleWriter(ParametersClusterNtuple);
+}
+
+//------------------------------------------------------------------------
+SiStripMonitorTrack::~SiStripMonitorTrack() { 
+  if (dcsStatus_) delete dcsStatus_;
+  if (genTriggerEventFlag_) delete genTriggerEventFlag_;
+  if (clusterNtuple_) delete clusterNtuple_;
+  if (tkhisto_StoNCorrOnTrack) delete tkhisto_StoNCorrOnTrack;
+  if (tkhisto_NumOnTrack) delete tkhisto_NumOnTrack;
+  if (tkhisto_NumOffTrack) delete tkhisto_NumOffTrack;
+}
+
+//------------------------------------------------------------------------
+void SiStripMonitorTrack::beginRun(const edm::Run& run,const edm::EventSetup& es)
+{
+  // field for the helix extrapolation of the trajectory-free on-track mode
+  bool needField = HelixAngleValidation_;
+  for (unsigned int input = 0; input < trackInputs_.size(); ++input) needField |= !trackInputs_[input].trajectoryInEvent;
+  if (needField) conditions_.require(SiStripConditionsContext::Field);
+  // topology, geometry, cabling (and field) of the new IOVs
+  pendingChanges_ |= conditions_.update(es);
+  LogDebug("SiStripMonitorTrack") << "[SiStripMonitorTrack::beginRun] There are "<<conditions_.geometry()->detUnits().size() <<" detectors instantiated in the geometry" << std::endl;  
+
+  // MEs of the previous run start again from zero; new modules are booked
+  // only if the cabling or the geometry changed
+  if (booked_) resetMEs();
+  if (!booked_ || (pendingChanges_ & (SiStripConditionsContext::Cabling | SiStripConditionsContext::Geometry))) book(conditions_.topology());
+  booked_ = true;
+  pendingChanges_ = 0;
+
+  if (clusterNtuple_) clusterNtuple_->open();
+
+  // Initialize the GenericTriggerEventFlag
+  if ( genTriggerEventFlag_->on() )genTriggerEventFlag_->initRun( run, es );
+  eventFilterCache_.beginRun();
+}
+
+//------------------------------------------------------------------------
+void SiStripMonitorTrack::endLuminosityBlock(const edm::LuminosityBlock& lumi, const edm::EventSetup& es)
+{
+  if (fillQueue_.on()) fillQueue_.flush();
+  if (TkHistoMap_On_) flushTkHistoMaps();
+  if (Trend_On_) fillTrends();
+  if (ModStatistics_On_) publishModuleStatistics();
+  if (Mod_On_ && !ModStatistics_On_) flushPGV();
+  if (APV_On_) apvAccumulator_.fill(APVSummary);
+  if (qualityTests_.on()) qualityTests_.endLumi();
+}
+
+//------------------------------------------------------------------------
+void SiStripMonitorTrack::endRun(const edm::Run& run, const edm::EventSetup& es)
+{
+  if (fillQueue_.on()) fillQueue_.flush();
+  if (TkHistoMap_On_) flushTkHistoMaps();
+  if (Trend_On_) fillTrends();
+  if (ModStatistics_On_) publishModuleStatistics();
+  if (Mod_On_ && !ModStatistics_On_) flushPGV();
+  if (APV_On_) apvAccumulator_.fill(APVSummary);
+  if (qualityTests_.on()) qualityTests_.endRun();
+}
+
+//------------------------------------------------------------------------
+void SiStripMonitorTrack::endJob(void)
+{
+  if (clusterNtuple_) clusterNtuple_->close();
+
+  if(conf_.getParameter<bool>("OutputMEsInRootFile")){
+    dbe->showDirStructure();
+    dbe->save(conf_.getParameter<std::string>("OutputFileName"));
+  }
+}
+
+// ------------ method called to produce the data  ------------
+void SiStripMonitorTrack::analyze(const edm::Event& e, const edm::EventSetup& es)
+{
+  // Filter out events if DCS checking is requested
+  if (dcsStatus_ && !eventFilterCache_.dcsStatus(*dcsStatus_,e,es)) return;
+  
+  // Filter out events if Trigger Filtering is requested
+  if (genTriggerEventFlag_->on()) {
+    if (eventFilterCache_.fastHlt() ? !eventFilterCache_.acceptHlt(e) : !genTriggerEventFlag_->accept( e, es) ) return;
+  }
+  
+  //initialization of global quantities
+  LogDebug("SiStripMonitorTrack") << "[SiStripMonitorTrack::analyse]  " << "Run " << e.id().run() << " Event " << e.id().event() << std::endl;
+  runNb   = e.id().run();
+  eventNb = e.id().event();
+  lumiNb  = e.id().luminosityBlock();
+  vOnTrackStrips.clear();
+
+  // clusters of the event, with one on-track bit per track input
+  edm::Handle< edmNew::DetSetVector<SiStripCluster> > siStripClusterHandle;
+  e.getByLabel( Cluster_src_, siStripClusterHandle);
+  firstCluster_ = 0;
+  onTrackMask_.clear();
+  onTrackClusters_.clear();
+  if (siStripClusterHandle.isValid() && siStripClusterHandle->dataSize() > 0) {
+    firstCluster_ = &siStripClusterHandle->data().front();
+    onTrackMask_.resize(siStripClusterHandle->dataSize(), 0);
+  }
+  onTrackSlot_.assign(onTrackMask_.size(), -1);
+
+  // per-event cluster quantities computed once by SiStripClusterFeatureProducer
+  clusterFeatures_ = 0;
+  if (!ClusterFeatures_.label().empty()) {
+    edm::Handle<SiStripClusterFeatures> clusterFeaturesHandle;
+    e.getByLabel(ClusterFeatures_, clusterFeaturesHandle);
+    if (clusterFeaturesHandle.isValid()) clusterFeatures_ = clusterFeaturesHandle.product();
+    else edm::LogError("SiStripMonitorTrack") << "ClusterFeatures " << ClusterFeatures_ << " not found, the cluster quantities are recomputed" << std::endl;
+  }
+  
+  iOrbitSec = e.orbitNumber()/11223.0;
+
+  // EventSetup products, fetched again only on a new IOV
+  pendingChanges_ |= conditions_.update(es);
+  const SiStripConditionsContext& conditions = conditions_;
+
+  //Perform track study, one track input after the other
+  for (currentInput_ = 0; currentInput_ < trackInputs_.size(); ++currentInput_) {
+    resetOnTrackClusters();
+    if (trackInputs_[currentInput_].trajectoryInEvent) trackStudy(e, es, conditions);
+    else trackStudyFromTracks(e, es, conditions);
+  }
+  currentInput_ = 0;
+  
+  //Perform raw digi study under the on-track clusters
+  if (RawDigis_On_) rawDigiStudy(e, es, conditions);
+
+  //Perform Cluster Study (irrespectively to tracks), once for all the track inputs
+  if (siStripClusterHandle.isValid()) AllClusters(siStripClusterHandle, es, conditions); //analyzes the off Track Clusters
+  else edm::LogError("SiStripMonitorTrack")<< "ClusterCollection is not valid!!" << std::endl;
+
+  //Summary Counts of clusters, the counters are zero again for the next event
+  // trend point: one per Steps lumi sections (UpdateMode 1) or per Steps seconds
+  uint32_t trendKey = (TrendUpdateMode_ == 1) ? lumiNb/TrendSteps_ : uint32_t(iOrbitSec)/TrendSteps_;
+  for (unsigned int input = 0; input < trackInputs_.size(); ++input) {
+    std::map<std::string, SubDetMEs>& subDetMEs = subDetMEsMap(input);
+    for (std::map<std::string, SubDetMEs>::iterator iSubDet = subDetMEs.begin();
+	 iSubDet != subDetMEs.end(); iSubDet++) {
+      SubDetMEs& subdet_mes = iSubDet->second;
+      SubDetFills& fills = *subdet_mes.fills;
+      queueME(subdet_mes.nClustersOnTrack, fills.totNClustersOnTrack);
+      queueME(subdet_mes.nClustersOffTrack, fills.totNClustersOffTrack);
+      if (Trend_On_) {
+	subdet_mes.TrendOnTrack.append(trendKey, fills.totNClustersOnTrack);
+	subdet_mes.TrendOffTrack.append(trendKey, fills.totNClustersOffTrack);
+      }
+      fills.totNClustersOnTrack  = 0;
+      fills.totNClustersOffTrack = 0;
+    }
+  }
+
+  // re-evaluate the hot modules every CheckInterval events
+  if (hotModuleFinder_.endEvent()) publishHotModules();
+
+  if (fillQueue_.on() && fillQueue_.endEvent()) fillQueue_.flush();
+  releaseEventScratch();
+}
+
+//------------------------------------------------------------------------
+void SiStripMonitorTrack::releaseEventScratch()
+{
+  // the containers give their storage back before the arena is reset
+  ScratchVector<uint8_t>(onTrackMask_.get_allocator()).swap(onTrackMask_);
+  ScratchVector<int32_t>(onTrackSlot_.get_allocator()).swap(onTrackSlot_);
+  ScratchVector<OnTrackCluster>(onTrackClusters_.get_allocator()).swap(onTrackClusters_);
+  ScratchVector<OnTrackStrips>(vOnTrackStrips.get_allocator()).swap(vOnTrackStrips);
+#ifdef EDM_ML_DEBUG
+  // constant once the arena has grown to the largest event; allocations outside
+  // the arena (SiStripClusterInfo, framework) are not counted here
+  LogDebug("SiStripMonitorTrackArena") << "Event " << eventNb << ": " << eventArena_.used() << " bytes of scratch, "
+				       << eventArena_.heapAllocations() << " arena chunk(s) taken from the heap since the start" << std::endl;
+#endif
+  eventArena_.reset();
+}
+
+//------------------------------------------------------------------------  
+void SiStripMonitorTrack::book(const TrackerTopology* tTopo)
+{
+  // booking time, reported for test/SiStripMonitorTrack_BookingBenchmark_cfg.py
+  std::chrono::steady_clock::time_point bookStart = std::chrono::steady_clock::now();
+  
+  SiStripFolderOrganizer folder_organizer;
+  //******** TkHistoMaps
+  if (TkHistoMap_On_ && tkhisto_NumOnTrack == 0) {
+    tkhisto_StoNCorrOnTrack = new TkHistoMap("SiStrip/TkHisto" ,"TkHMap_StoNCorrOnTrack",0.0,1); 
+    tkhisto_NumOnTrack  = new TkHistoMap("SiStrip/TkHisto", "TkHMap_NumberOfOnTrackCluster",0.0,1);
+    tkhisto_NumOffTrack = new TkHistoMap("SiStrip/TkHisto", "TkHMap_NumberOfOfffTrackCluster",0.0,1);
+  }
+  //******** TkHistoMaps
+
+  std::vector<uint32_t> vdetId_;
+  conditions_.cabling()->addActiveDetectorsRawIds(vdetId_);
+  // dense module index for the flag table: static exclusions + hot modules
+  std::vector<uint16_t> vlayer_;
+  std::map<std::string, uint16_t> layerNumbers;
+  std::vector<uint32_t> layerFirstDetIds;
+  //Histos for each detector, layer and module
+  for (std::vector<uint32_t>::const_iterator detid_iter=vdetId_.begin();detid_iter!=vdetId_.end();detid_iter++){  //loop on all the active detid
+    uint32_t detid = *detid_iter;
+    
+    if (detid < 1){
+      edm::LogError("SiStripMonitorTrack")<< "[" <<__PRETTY_FUNCTION__ << "] invalid detid " << detid<< std::endl;
+      vlayer_.push_back(0);
+      continue;
+    }
+
+    
+    // modules booked in a previous run: only their layer is needed
+    std::map<uint32_t, std::string>::iterator iBooked = bookedModules_.find(detid);
+    bool booked = iBooked != bookedModules_.end();
+    SiStripHistoId hidmanager;
+    std::string layer_id = booked ? iBooked->second : hidmanager.getSubdetid(detid, tTopo, flag_ring);
+    std::pair<std::map<std::string, uint16_t>::iterator, bool> iLayerNumber = layerNumbers.insert(std::make_pair(layer_id, uint16_t(layerNumbers.size())));
+    if (iLayerNumber.second) layerFirstDetIds.push_back(detid);
+    vlayer_.push_back(iLayerNumber.first->second);
+    if (booked) continue;
+    bookedModules_[detid] = layer_id;
+    
+    // book Layer and RING plots
+    std::pair<std::string,int32_t> det_layer_pair = folder_organizer.GetSubDetAndLayer(detid,tTopo,flag_ring);
+    std::map<std::string, LayerMEs>::iterator iLayerME  = LayerMEsMap.find(layer_id);
+    if(iLayerME==LayerMEsMap.end()){
+      folder_organizer.setLayerFolder(detid, tTopo, det_layer_pair.second, flag_ring);
+      for (unsigned int input = 0; input < trackInputs_.size(); ++input) bookLayerMEs(detid, layer_id, input);
+    }
+    // book sub-detector plots
+    std::pair<std::string,std::string> sdet_pair = folder_organizer.getSubDetFolderAndTag(detid, tTopo);
+    if (SubDetMEsMap.find(sdet_pair.second) == SubDetMEsMap.end()){
+      dbe->setCurrentFolder(sdet_pair.first);
+      for (unsigned int input = 0; input < trackInputs_.size(); ++input) bookSubDetMEs(sdet_pair.second, input);
+    }
+    // book module plots
+    if(Mod_On_ && !ModStatistics_On_) {
+      folder_organizer.setDetectorFolder(detid,tTopo);
+      bookModMEs(*detid_iter);
+    } 
+  }//end loop on detectors detid
+
+  hotModuleFinder_.setModules(vdetId_, vlayer_);
+  hotModuleFinder_.exclude(ModulesToBeExcluded_);
+
+  // ME pointers of the modules, on the module index of hotModuleFinder_
+  buildModuleMEs(vdetId_);
+  if (TkHistoMap_On_) {
+    tkhistoAccStoNCorrOnTrack_.setModules(vdetId_, edm::Service<TkDetMap>().operator->());
+    tkhistoAccNumOnTrack_.setModules(vdetId_);
+    tkhistoAccNumOffTrack_.setModules(vdetId_);
+  }
+  if (Mod_On_ && !ModStatistics_On_) pgvAccumulator_.setModules(vdetId_.size());
+
+  if (qualityTests_.on()) {
+    folder_organizer.setSiStripFolder();
+    qualityTests_.book(dbe);
+  }
+
+  // MEs that do not depend on the module list: booked once
+  if (clusterSampler_.on() && SamplingFraction == 0) {
+    folder_organizer.setSiStripFolder();
+    SamplingFraction = dbe->book1D("Summary_OffTrackSamplingFraction", "Summary_OffTrackSamplingFraction", 101, -0.005, 1.005);
+    SamplingFraction->setAxisTitle("sampled fraction of the off-track clusters", 1);
+    SamplingFraction->setAxisTitle("events", 2);
+  }
+
+  // per-APV accumulators, on the module index of hotModuleFinder_; the APVs of
+  // a module from its strips in the geometry, uncabled APV pairs included
+  if (APV_On_) {
+    std::vector<uint16_t> vnapvs_(vdetId_.size(), 0);
+    for (uint32_t i = 0; i < vdetId_.size(); ++i) {
+      if (vdetId_[i] == 0) continue;
+      const StripGeomDetUnit* stripDet = dynamic_cast<const StripGeomDetUnit*>(conditions_.geometry()->idToDetUnit(DetId(vdetId_[i])));
+      if (stripDet) vnapvs_[i] = stripDet->specificTopology().nstrips()/128;
+    }
+    apvAccumulator_.setModules(vdetId_, vnapvs_);
+    folder_organizer.setSiStripFolder();
+    // binning and labels follow the module list: book again on a new one
+    if (APVSummary) dbe->removeElement(APVSummary->getPathname(), APVSummary->getName());
+    APVSummary = apvAccumulator_.book(dbe, "Summary_APV_OnTrack");
+  }
+
+  // one module statistics summary per layer, on the module index of hotModuleFinder_
+  if (ModStatistics_On_) {
+    moduleStatistics_.setModules(vdetId_, vlayer_);
+    // binning and labels follow the module list: book again on a new one
+    for (std::vector<MonitorElement*>::iterator iME = ModuleStatisticsMEs.begin(); iME != ModuleStatisticsMEs.end(); ++iME)
+      if (*iME) dbe->removeElement((*iME)->getPathname(), (*iME)->getName());
+    ModuleStatisticsMEs.assign(layerNumbers.size(), (MonitorElement*)0);
+    SiStripHistoId hidmanager;
+    for (std::map<std::string, uint16_t>::const_iterator iLayer = layerNumbers.begin(); iLayer != layerNumbers.end(); ++iLayer) {
+      uint32_t detid = layerFirstDetIds[iLayer->second];
+      folder_organizer.setLayerFolder(detid, tTopo, folder_organizer.GetSubDetAndLayer(detid,tTopo,flag_ring).second, flag_ring);
+      std::string hname = hidmanager.createHistoLayer("Summary_ModuleStatistics","layer",iLayer->first,"OnTrack");
+      ModuleStatisticsMEs[iLayer->second] = moduleStatistics_.book(dbe, hname, iLayer->second);
+    }
+  }
+  if (hotModuleFinder_.on() && HotModules == 0) {
+    folder_organizer.setSiStripFolder();
+    HotModules  = dbe->bookString("HotModules", "");
+    nHotModules = dbe->bookInt("NumberOfHotModules");
+  }
+
+  edm::LogInfo("SiStripMonitorTrackBooking") << "[SiStripMonitorTrack::book] " << vdetId_.size() << " active modules booked in "
+					     << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - bookStart).count() << " ms";
+}
+  
+//------------------------------------------------------------------------
+// ME pointers of the booked modules, the event loop builds no histogram name
+void SiStripMonitorTrack::buildModuleMEs(const std::vector<uint32_t>& detids)
+{
+  // fill blocks of the layers and sub-detectors, all the track inputs
+  size_t nLayers = 0, nSubDets = 0;
+  for (unsigned int input = 0; input < trackInputs_.size(); ++input) {
+    nLayers  += layerMEsMap(input).size();
+    nSubDets += subDetMEsMap(input).size();
+  }
+  layerFills_.assign(nLayers);
+  subDetFills_.assign(nSubDets);
+  nLayers = nSubDets = 0;
+  for (unsigned int input = 0; input < trackInputs_.size(); ++input) {
+    std::map<std::string, LayerMEs>& layerMEs = layerMEsMap(input);
+    for (std::map<std::string, LayerMEs>::iterator iLayer = layerMEs.begin(); iLayer != layerMEs.end(); ++iLayer) {
+      LayerMEs& layer_mes = iLayer->second;
+      LayerFills& fills = layerFills_[nLayers++];
+      fills.ClusterStoNCorrOnTrack   = layer_mes.ClusterStoNCorrOnTrack;
+      fills.ClusterChargeCorrOnTrack = layer_mes.ClusterChargeCorrOnTrack;
+      fills.ClusterChargeOnTrack     = layer_mes.ClusterChargeOnTrack;
+      fills.ClusterNoiseOnTrack      = layer_mes.ClusterNoiseOnTrack;
+      fills.ClusterWidthOnTrack      = layer_mes.ClusterWidthOnTrack;
+      fills.ClusterPosOnTrack        = layer_mes.ClusterPosOnTrack;
+      fills.qtStoNCorr               = layer_mes.qtStoNCorr;
+      fills.qtWidth                  = layer_mes.qtWidth;
+      fills.ClusterChargeOffTrack    = layer_mes.ClusterChargeOffTrack;
+      fills.ClusterNoiseOffTrack     = layer_mes.ClusterNoiseOffTrack;
+      fills.ClusterWidthOffTrack     = layer_mes.ClusterWidthOffTrack;
+      fills.ClusterPosOffTrack       = layer_mes.ClusterPosOffTrack;
+      fills.mes                      = &layer_mes;
+      layer_mes.fills = &fills;
+    }
+    std::map<std::string, SubDetMEs>& subDetMEs = subDetMEsMap(input);
+    for (std::map<std::string, SubDetMEs>::iterator iSubdet = subDetMEs.begin(); iSubdet != subDetMEs.end(); ++iSubdet) {
+      SubDetMEs& subdet_mes = iSubdet->second;
+      SubDetFills& fills = subDetFills_[nSubDets++];
+      fills.ClusterStoNCorrOnTrack       = subdet_mes.ClusterStoNCorrOnTrack;
+      fills.ClusterChargeOffTrack        = subdet_mes.ClusterChargeOffTrack;
+      fills.ClusterStoNOffTrack          = subdet_mes.ClusterStoNOffTrack;
+      fills.ClusterStoNCorrSharedOnTrack = subdet_mes.ClusterStoNCorrSharedOnTrack;
+      fills.DeltaCosRZHelixOnTrack       = subdet_mes.DeltaCosRZHelixOnTrack;
+      fills.qtStoNCorr                   = subdet_mes.qtStoNCorr;
+      subdet_mes.fills = &fills;
+    }
+  }
+
+  moduleMEs_.resize(detids.size()*trackInputs_.size());
+  modFills_.assign((Mod_On_ && !ModStatistics_On_) ? detids.size() : 0);
+  unlistedModuleMEs_.clear();
+  SiStripHistoId hidmanager;
+  for (uint32_t i = 0; i < detids.size(); ++i) {
+    lookupModuleMEs(detids[i], &moduleMEs_[i*trackInputs_.size()]);
+    if (Mod_On_ && !ModStatistics_On_) {
+      std::map<std::string, ModMEs>::iterator iModME = ModMEsMap.find(hidmanager.createHistoId("","det",detids[i]));
+      if (iModME != ModMEsMap.end()) {
+	modFills_[i].mes    = iModME->second;
+	modFills_[i].booked = true;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+void SiStripMonitorTrack::lookupModuleMEs(uint32_t detid, ModuleMEs* mes)
+{
+  for (unsigned int input = 0; input < trackInputs_.size(); ++input) {
+    mes[input].layer  = 0;
+    mes[input].subdet = 0;
+  }
+  if (detid < 1) return;
+  SiStripHistoId hidmanager;
+  std::string layer_id = hidmanager.getSubdetid(detid, conditions_.topology(), flag_ring);
+  std::string subdet_tag = folderOrganizer_.getSubDetFolderAndTag(detid, conditions_.topology()).second;
+  for (unsigned int input = 0; input < trackInputs_.size(); ++input) {
+    std::map<std::string, LayerMEs>& layerMEs = layerMEsMap(input);
+    std::map<std::string, LayerMEs>::iterator iLayer = layerMEs.find(layer_id);
+    if (iLayer != layerMEs.end()) mes[input].layer = iLayer->second.fills;
+    std::map<std::string, SubDetMEs>& subDetMEs = subDetMEsMap(input);
+    std::map<std::string, SubDetMEs>::iterator iSubdet = subDetMEs.find(subdet_tag);
+    if (iSubdet != subDetMEs.end()) mes[input].subdet = iSubdet->second.fills;
+  }
+}
+
+//------------------------------------------------------------------------
+// modules with clusters but not in the cabling: looked up on their first cluster
+const std::vector<SiStripMonitorTrack::ModuleMEs>& SiStripMonitorTrack::unlistedModuleMEs(uint32_t detid)
+{
+  std::map<uint32_t, std::vector<ModuleMEs> >::iterator it = unlistedModuleMEs_.find(detid);
+  if (it == unlistedModuleMEs_.end()) {
+    it = unlistedModuleMEs_.insert(std::make_pair(detid, std::vector<ModuleMEs>(trackInputs_.size()))).first;
+    lookupModuleMEs(detid, &it->second[0]);
+  }
+  return it->second;
+}
+
+//--------------------------------------------------------------------------------
+void SiStripMonitorTrack::resetMEs()
+{
+  for (std::vector<MonitorElement*>::iterator iME = bookedMEs_.begin(); iME != bookedMEs_.end(); ++iME) (*iME)->Reset();
+  TkHistoMap* tkhistos[3] = { tkhisto_StoNCorrOnTrack, tkhisto_NumOnTrack, tkhisto_NumOffTrack };
+  for (int i = 0; i < 3; ++i) {
+    if (tkhistos[i] == 0) continue;
+    std::vector<MonitorElement*>& maps = tkhistos[i]->getAllMaps();
+    for (std::vector<MonitorElement*>::iterator iME = maps.begin(); iME != maps.end(); ++iME)
+      if (*iME) (*iME)->Reset();
+  }
+  if (SamplingFraction) SamplingFraction->Reset();
+
+  for (unsigned int input = 0; input < trackInputs_.size(); ++input) {
+    std::map<std::string, SubDetMEs>& subDetMEs = subDetMEsMap(input);
+    for (std::map<std::string, SubDetMEs>::iterator iSubDet = subDetMEs.begin(); iSubDet != subDetMEs.end(); ++iSubDet) {
+      iSubDet->second.TrendOnTrack.reset();
+      iSubDet->second.TrendOffTrack.reset();
+    }
+  }
+  // the accumulators rewrite their MEs when published
+  hotModuleFinder_.reset();
+  publishedHotModules_.clear();
+  pgvAccumulator_.reset();
+  if (APV_On_) apvAccumulator_.reset();
+  if (ModStatistics_On_) moduleStatistics_.reset();
+}
+
+//--------------------------------------------------------------------------------
+void SiStripMonitorTrack::bookModMEs(const uint32_t & id)//Histograms at MODULE level
+{
+  std::string name = "det";
+  SiStripHistoId hidmanager;
+  std::string hid = hidmanager.createHistoId("",name,id);
+  std::map<std::string, ModMEs>::iterator iModME  = ModMEsMap.find(hid);
+  if(iModME==ModMEsMap.end()){
+    ModMEs theModMEs; 
+    theModMEs.ClusterStoNCorr   = 0;
+    theModMEs.ClusterCharge     = 0;
+    theModMEs.ClusterChargeCorr = 0;
+    theModMEs.ClusterWidth      = 0;
+    theModMEs.ClusterPos        = 0;
+    theModMEs.ClusterPGV        = 0;
+
+    // Cluster Width
+    theModMEs.ClusterWidth=bookME1D(TH1ClusterWidth, hidmanager.createHistoId("ClusterWidth_OnTrack",name,id).c_str()); 
+    dbe->tag(theModMEs.ClusterWidth,id); 
+    // Cluster Charge
+    theModMEs.ClusterCharge=bookME1D(TH1ClusterCharge, hidmanager.createHistoId("ClusterCharge_OnTrack",name,id).c_str());
+    dbe->tag(theModMEs.ClusterCharge,id); 
+    // Cluster Charge Corrected
+    theModMEs.ClusterChargeCorr=bookME1D(TH1ClusterChargeCorr, hidmanager.createHistoId("ClusterChargeCorr_OnTrack",name,id).c_str());
+    dbe->tag(theModMEs.ClusterChargeCorr,id); 
+    // Cluster StoN Corrected
+    theModMEs.ClusterStoNCorr=bookME1D(TH1ClusterStoNCorrMod, hidmanager.createHistoId("ClusterStoNCorr_OnTrack",name,id).c_str());
+    dbe->tag(theModMEs.ClusterStoNCorr,id); 
+    // Cluster Position
+    short total_nr_strips = conditions_.cabling()->nApvPairs(id) * 2 * 128;
+    theModMEs.ClusterPos=dbe->book1D(hidmanager.createHistoId("ClusterPosition_OnTrack",name,id).c_str(),hidmanager.createHistoId("ClusterPosition_OnTrack",name,id).c_str(),total_nr_strips,0.5,total_nr_strips+0.5);
+    if (theModMEs.ClusterPos) bookedMEs_.push_back(theModMEs.ClusterPos);
+    dbe->tag(theModMEs.ClusterPos,id); 
+    // Cluster PGV
+    theModMEs.ClusterPGV=bookMEProfile(TProfileClusterPGV, hidmanager.createHistoId("PGV_OnTrack",name,id).c_str()); 
+    dbe->tag(theModMEs.ClusterPGV,id); 
+
+    ModMEsMap[hid]=theModMEs;
+  }
+}
+//
+// -- Book Layer Level Histograms and Trend plots
+//
+void SiStripMonitorTrack::bookLayerMEs(const uint32_t& mod_id, std::string& layer_id, unsigned int input)
+{
+  std::string name = "layer";  
+  // the additional track inputs only have on-track MEs, flagged OnTrack_<Tag>
+  bool primary = (input == 0);
+  std::string onTrack = "OnTrack" + trackInputs_[input].suffix;
+  std::string hname;
+  SiStripHistoId hidmanager;
+
+  LayerMEs theLayerMEs; 
+  theLayerMEs.ClusterStoNCorrOnTrack   = 0;
+  theLayerMEs.ClusterChargeCorrOnTrack = 0;
+  theLayerMEs.ClusterChargeOnTrack     = 0;
+  theLayerMEs.ClusterChargeOffTrack    = 0;
+  theLayerMEs.ClusterNoiseOnTrack      = 0;
+  theLayerMEs.ClusterNoiseOffTrack     = 0;
+  theLayerMEs.ClusterWidthOnTrack      = 0;
+  theLayerMEs.ClusterWidthOffTrack     = 0;
+  theLayerMEs.ClusterPosOnTrack        = 0;
+  theLayerMEs.ClusterPosOffTrack       = 0;
+  theLayerMEs.RawCommonMode            = 0;
+  theLayerMEs.RawNoise                 = 0;
+  theLayerMEs.RawOccupancyOnTrack      = 0;
+  theLayerMEs.qtStoNCorr               = -1;
+  theLayerMEs.qtWidth                  = -1;
+  theLayerMEs.fills                    = 0;
+  
+  // Cluster StoN Corrected
+  if (layerstoncorrontrack){
+    hname = hidmanager.createHistoLayer("Summary_ClusterStoNCorr",name,layer_id,onTrack);
+    theLayerMEs.ClusterStoNCorrOnTrack = bookME1D(TH1ClusterStoNCorr, hname.c_str());
+    if (primary && qualityTests_.on()) theLayerMEs.qtStoNCorr = qualityTests_.addUnit(SiStripQualityTests::StoNCorrMean, layer_id);
+  }
+
+  // Cluster Charge Corrected
+  if (layerchargecorr){
+    hname = hidmanager.createHistoLayer("Summary_ClusterChargeCorr",name,layer_id,onTrack);
+    theLayerMEs.ClusterChargeCorrOnTrack = bookME1D(TH1ClusterChargeCorr, hname.c_str());
+  }
+
+  // Cluster Charge (On and Off Track)
+  if (layercharge){
+    hname = hidmanager.createHistoLayer("Summary_ClusterCharge",name,layer_id,onTrack);
+    theLayerMEs.ClusterChargeOnTrack = bookME1D(TH1ClusterCharge, hname.c_str());
+  
+    if (primary) {
+      hname = hidmanager.createHistoLayer("Summary_ClusterCharge",name,layer_id,"OffTrack");
+      theLayerMEs.ClusterChargeOffTrack = bookME1D(TH1ClusterCharge, hname.c_str());
+    }
+  }
+
+  // Cluster Noise (On and Off Track)
+  hname = hidmanager.createHistoLayer("Summary_ClusterNoise",name,layer_id,onTrack);
+  theLayerMEs.ClusterNoiseOnTrack = bookME1D(TH1ClusterNoise, hname.c_str()); 
+
+  if (primary) {
+    hname = hidmanager.createHistoLayer("Summary_ClusterNoise",name,layer_id,"OffTrack");
+    theLayerMEs.ClusterNoiseOffTrack = bookME1D(TH1ClusterNoise, hname.c_str()); 
+  }
+
+  if (layernoise){
+    hname = hidmanager.createHistoLayer("Summary_ClusterNoise",name,layer_id,onTrack);
+    theLayerMEs.ClusterNoiseOnTrack = bookME1D(TH1ClusterNoise, hname.c_str()); 
+    
+    if (primary) {
+      hname = hidmanager.createHistoLayer("Summary_ClusterNoise",name,layer_id,"OffTrack");
+      theLayerMEs.ClusterNoiseOffTrack = bookME1D(TH1ClusterNoise, hname.c_str()); 
+    }
+  }
+  // Cluster Width (On and Off Track)
+  if (layerwidth){
+    hname = hidmanager.createHistoLayer("Summary_ClusterWidth",name,layer_id,onTrack);
+    theLayerMEs.ClusterWidthOnTrack = bookME1D(TH1ClusterWidth, hname.c_str()); 
+    if (primary && qualityTests_.on()) theLayerMEs.qtWidth = qualityTests_.addUnit(SiStripQualityTests::WidthContents, layer_id);
+    
+    if (primary) {
+      hname = hidmanager.createHistoLayer("Summary_ClusterWidth",name,layer_id,"OffTrack");
+      theLayerMEs.ClusterWidthOffTrack = bookME1D(TH1ClusterWidth, hname.c_str()); 
+    }
+  }
+
+  //Cluster Position
+  short total_nr_strips = conditions_.cabling()->nApvPairs(mod_id) * 2 * 128; 
+  if (layer_id.find("TEC") != std::string::npos && !flag_ring)  total_nr_strips = 3 * 2 * 128;
+  
+  hname = hidmanager.createHistoLayer("Summary_ClusterPosition",name,layer_id,onTrack);
+  theLayerMEs.ClusterPosOnTrack = dbe->book1D(hname, hname, total_nr_strips, 0.5,total_nr_strips+0.5);
+  if (theLayerMEs.ClusterPosOnTrack) bookedMEs_.push_back(theLayerMEs.ClusterPosOnTrack);
+  
+  if (primary) {
+    hname = hidmanager.createHistoLayer("Summary_ClusterPosition",name,layer_id,"OffTrack");
+    theLayerMEs.ClusterPosOffTrack = dbe->book1D(hname, hname, total_nr_strips, 0.5,total_nr_strips+0.5);
+    if (theLayerMEs.ClusterPosOffTrack) bookedMEs_.push_back(theLayerMEs.ClusterPosOffTrack);
+  }
+
+  // Raw digis: per APV common mode and noise, occupancy under the on-track clusters
+  if (RawDigis_On_ && primary) {
+    hname = hidmanager.createHistoLayer("Summary_RawCommonMode",name,layer_id,"");
+    theLayerMEs.RawCommonMode = bookME1D(TH1RawCommonMode, hname.c_str());
+
+    hname = hidmanager.createHistoLayer("Summary_RawNoise",name,layer_id,"");
+    theLayerMEs.RawNoise = bookME1D(TH1RawNoise, hname.c_str());
+
+    hname = hidmanager.createHistoLayer("Summary_RawOccupancy",name,layer_id,onTrack);
+    theLayerMEs.RawOccupancyOnTrack = bookME1D(TH1RawOccupancy, hname.c_str());
+  }
+  
+  //bookeeping
+  layerMEsMap(input)[layer_id]=theLayerMEs;
+}
+//
+// -- Book Histograms at Sub-Detector Level
+//
+void SiStripMonitorTrack::bookSubDetMEs(std::string& name, unsigned int input){
+
+  const TrackInput& trackInput = trackInputs_[input];
+
+  std::string subdet_tag;
+  subdet_tag = trackInput.suffix + "__" + name;
+  std::string completeName;
+
+  SubDetMEs theSubDetMEs;
+  theSubDetMEs.nClustersOnTrack       = 0;
+  theSubDetMEs.nClustersTrendOnTrack  = 0;
+  theSubDetMEs.nClustersOffTrack      = 0;
+  theSubDetMEs.nClustersTrendOffTrack = 0;
+  theSubDetMEs.ClusterStoNCorrOnTrack = 0;
+  theSubDetMEs.ClusterChargeOffTrack  = 0;
+  theSubDetMEs.ClusterStoNOffTrack    = 0;
+  theSubDetMEs.DeltaCosRZHelixOnTrack = 0;
+  theSubDetMEs.ClusterStoNCorrSharedOnTrack = 0;
+  theSubDetMEs.qtStoNCorr             = -1;
+  theSubDetMEs.fills                  = 0;
+
+  // TotalNumber of Cluster OnTrack
+  completeName = "Summary_TotalNumberOfClusters_OnTrack" + subdet_tag;
+  theSubDetMEs.nClustersOnTrack = bookME1D(TH1nClustersOn, completeName.c_str());
+  theSubDetMEs.nClustersOnTrack->getTH1()->StatOverflows(kTRUE);
+  
+  // TotalNumber of Cluster OffTrack
+  completeName = "Summary_TotalNumberOfClusters_OffTrack" + subdet_tag;
+  theSubDetMEs.nClustersOffTrack = bookME1D(TH1nClustersOff, completeName.c_str());
+  theSubDetMEs.nClustersOffTrack->getTH1()->StatOverflows(kTRUE);
+  
+  // Cluster StoN On Track
+  completeName = "Summary_ClusterStoNCorr_OnTrack"  + subdet_tag;
+  theSubDetMEs.ClusterStoNCorrOnTrack = bookME1D(TH1ClusterStoNCorr, completeName.c_str());
+  if (input == 0 && qualityTests_.on()) theSubDetMEs.qtStoNCorr = qualityTests_.addUnit(SiStripQualityTests::StoNCorrMean, name);
+
+  // Cluster StoN of the clusters shared with a previous track
+  if (sharedClusters_ == FillShared) {
+    completeName = "Summary_ClusterStoNCorr_SharedOnTrack"  + subdet_tag;
+    theSubDetMEs.ClusterStoNCorrSharedOnTrack = bookME1D(TH1ClusterStoNCorr, completeName.c_str());
+  }
+  
+  // off-track cluster distributions only for the primary track input
+  if (input == 0) {
+    // Cluster Charge Off Track
+    completeName = "Summary_ClusterCharge_OffTrack" + subdet_tag;
+    theSubDetMEs.ClusterChargeOffTrack=bookME1D(TH1ClusterCharge, completeName.c_str());
+  
+    // Cluster Charge StoN Off Track
+    completeName = "Summary_ClusterStoN_OffTrack"  + subdet_tag;
+    theSubDetMEs.ClusterStoNOffTrack = bookME1D(TH1ClusterStoN, completeName.c_str());
+  }
+  
+  // cosRZ from the helix extrapolation minus cosRZ from the trajectory
+  if (trackInput.trajectoryInEvent && HelixAngleValidation_) {
+    completeName = "Summary_DeltaCosRZ_HelixMinusTrajectory_OnTrack"  + subdet_tag;
+    theSubDetMEs.DeltaCosRZHelixOnTrack = bookME1D(TH1DeltaCosRZ, completeName.c_str());
+  }
+
+  if(Trend_On_){
+    // TotalNumber of Cluster 
+    completeName = "Trend_TotalNumberOfClusters_OnTrack"  + subdet_tag;
+    theSubDetMEs.nClustersTrendOnTrack = bookMETrend(TH1nClustersOn, completeName.c_str());
+    completeName = "Trend_TotalNumberOfClusters_OffTrack"  + subdet_tag;
+    theSubDetMEs.nClustersTrendOffTrack = bookMETrend(TH1nClustersOff, completeName.c_str());
+    theSubDetMEs.TrendOnTrack  = SiStripTrendBuffer(TrendNbins_);
+    theSubDetMEs.TrendOffTrack = SiStripTrendBuffer(TrendNbins_);
+  }
+  //bookeeping
+  subDetMEsMap(input)[name]=theSubDetMEs;
+}
+//--------------------------------------------------------------------------------
+
+void SiStripMonitorTrack::parseBinnings()
+{
+  // same order as BinningLabel
+  static const char* const labels[NBinningLabels] = {
+    "TH1nClustersOn", "TH1nClustersOff", "TH1ClusterCharge", "TH1ClusterStoN", "TH1ClusterChargeCorr",
+    "TH1ClusterStoNCorr", "TH1ClusterStoNCorrMod", "TH1ClusterNoise", "TH1ClusterWidth",
+    "TH1RawCommonMode", "TH1RawNoise", "TH1RawOccupancy", "TH1DeltaCosRZ", "TProfileClusterPGV"
+  };
+  for (int label = 0; label < NBinningLabels; ++label) {
+    const edm::ParameterSet& pset = conf_.getParameter<edm::ParameterSet>(labels[label]);
+    BinningSpec& spec = binnings_[label];
+    spec.Nbinx = pset.getParameter<int32_t>("Nbinx");
+    spec.xmin  = pset.getParameter<double>("xmin");
+    spec.xmax  = pset.getParameter<double>("xmax");
+    spec.Nbiny = pset.exists("Nbiny") ? pset.getParameter<int32_t>("Nbiny") : 0;
+    spec.ymin  = pset.exists("ymin")  ? pset.getParameter<double>("ymin")   : 0.;
+    spec.ymax  = pset.exists("ymax")  ? pset.getParameter<double>("ymax")   : 0.;
+    spec.Nbinz = pset.exists("Nbinz") ? pset.getParameter<int32_t>("Nbinz") : 0;
+    spec.zmin  = pset.exists("zmin")  ? pset.getParameter<double>("zmin")   : 0.;
+    spec.zmax  = pset.exists("zmax")  ? pset.getParameter<double>("zmax")   : 0.;
+  }
+}
+
+//--------------------------------------------------------------------------------
+MonitorElement* SiStripMonitorTrack::bookME1D(BinningLabel label, const char* HistoName)
+{
+  const BinningSpec& spec = binnings_[label];
+  MonitorElement* me = dbe->book1D(HistoName,HistoName,spec.Nbinx,spec.xmin,spec.xmax);
+  if (me) bookedMEs_.push_back(me);
+  return me;
+}
+
+//--------------------------------------------------------------------------------
+MonitorElement* SiStripMonitorTrack::bookME2D(BinningLabel label, const char* HistoName)
+{
+  const BinningSpec& spec = binnings_[label];
+  MonitorElement* me = dbe->book2D(HistoName,HistoName,
+                                   spec.Nbinx,spec.xmin,spec.xmax,
+                                   spec.Nbiny,spec.ymin,spec.ymax);
+  if (me) bookedMEs_.push_back(me);
+  return me;
+}
+
+//--------------------------------------------------------------------------------
+MonitorElement* SiStripMonitorTrack::bookME3D(BinningLabel label, const char* HistoName)
+{
+  const BinningSpec& spec = binnings_[label];
+  MonitorElement* me = dbe->book3D(HistoName,HistoName,
+                                   spec.Nbinx,spec.xmin,spec.xmax,
+                                   spec.Nbiny,spec.ymin,spec.ymax,
+                                   spec.Nbinz,spec.zmin,spec.zmax);
+  if (me) bookedMEs_.push_back(me);
+  return me;
+}
+
+//--------------------------------------------------------------------------------
+MonitorElement* SiStripMonitorTrack::bookMEProfile(BinningLabel label, const char* HistoName)
+{
+  const BinningSpec& spec = binnings_[label];
+  MonitorElement* me = dbe->bookProfile(HistoName,HistoName,
+                                        spec.Nbinx,spec.xmin,spec.xmax,
+                                        spec.Nbiny,spec.ymin,spec.ymax,
+                                        "");
+  if (me) bookedMEs_.push_back(me);
+  return me;
+}
+
+//--------------------------------------------------------------------------------
+MonitorElement* SiStripMonitorTrack::bookMETrend(BinningLabel label, const char* HistoName)
+{
+  const BinningSpec& spec = binnings_[label];
+  // fixed binning: the content is rewritten from the SiStripTrendBuffer ring (see fillTrends)
+  MonitorElement* me = dbe->bookProfile(HistoName,HistoName,
+					TrendNbins_,
+					0,
+					TrendNbins_,
+					100, //that parameter should not be there !?
+					spec.xmin,
+					spec.xmax,
+					"" );
+
+  if(!me) return me;
+  bookedMEs_.push_back(me);
+  me->setAxisTitle(TrendUpdateMode_ == 1 ? "Lumi Section" : "Event Time in Seconds",1);
+  return me;
+}
+
+//------------------------------------------------------------------------------------------
+ void SiStripMonitorTrack::trackStudy(const edm::Event& ev, const edm::EventSetup& es, const SiStripConditionsContext& conditions){
+
+  // track input  
+  const TrackInput& trackInput = trackInputs_[currentInput_];
+ 
+  edm::Handle<reco::TrackCollection > trackCollectionHandle;
+  ev.getByLabel(trackInput.producer, trackInput.label, trackCollectionHandle);//takes the track collection
+  if (!trackCollectionHandle.isValid()){
+    edm::LogError("SiStripMonitorTrack")<<" Track Collection is not valid !! " << trackInput.producer << ":" << trackInput.label<<std::endl;
+    return;
+  }
+  
+  // trajectory input
+  edm::Handle<TrajTrackAssociationCollection> TItkAssociatorCollection;
+  ev.getByLabel(trackInput.producer, trackInput.label, TItkAssociatorCollection);
+  if( !TItkAssociatorCollection.isValid()){
+    edm::LogError("SiStripMonitorTrack")<<"Association not found "<<std::endl;
+    return;
+  }
+  
+  //Perform track study
+  int i=0;
+  for(TrajTrackAssociationCollection::const_iterator it =  TItkAssociatorCollection->begin();it !=  TItkAssociatorCollection->end(); ++it){
+    const edm::Ref<std::vector<Trajectory> > traj_iterator = it->key;  
+    // Trajectory Map, extract Trajectory for this track
+    reco::TrackRef trackref = it->val;
+    LogDebug("SiStripMonitorTrack")
+      << "Track number "<< i+1 
+      << "\n\tmomentum: " << trackref->momentum()
+      << "\n\tPT: " << trackref->pt()
+      << "\n\tvertex: " << trackref->vertex()
+      << "\n\timpact parameter: " << trackref->d0()
+      << "\n\tcharge: " << trackref->charge()
+      << "\n\tnormalizedChi2: " << trackref->normalizedChi2() 
+      <<"\n\tFrom EXTRA : "
+      <<"\n\t\touter PT "<< trackref->outerPt()<<std::endl;
+    i++;
+
+    const std::vector<TrajectoryMeasurement> & measurements = traj_iterator->measurements();
+    std::vector<TrajectoryMeasurement>::const_iterator traj_mes_iterator;
+    int nhit=0;
+    for(std::vector<TrajectoryMeasurement>::const_iterator traj_mes_iterator= measurements.begin();traj_mes_iterator!=measurements.end();traj_mes_iterator++){//loop on measurements
+      //trajectory local direction and position on detector
+      TrajectoryStateOnSurface  updatedtsos=traj_mes_iterator->updatedState();
+      ConstRecHitPointer ttrh=traj_mes_iterator->recHit();
+      if (!ttrh->isValid()) {continue;}
+      
+      nhit++;
+      
+      hitStudy(ttrh->hit(), &updatedtsos, trackref, es, conditions);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------------
+// On-track clusters straight from reco::Track::recHits, no refit and no trajectory needed.
+// The local direction used for cosRZ comes from a helix extrapolation of the track
+// parameters to the plane of each module (see helixDirection).
+void SiStripMonitorTrack::trackStudyFromTracks(const edm::Event& ev, const edm::EventSetup& es, const SiStripConditionsContext& conditions){
+
+  const TrackInput& trackInput = trackInputs_[currentInput_];
+  edm::Handle<reco::TrackCollection > trackCollectionHandle;
+  ev.getByLabel(trackInput.producer, trackInput.label, trackCollectionHandle);//takes the track collection
+  if (!trackCollectionHandle.isValid()){
+    edm::LogError("SiStripMonitorTrack")<<" Track Collection is not valid !! " << trackInput.producer << ":" << trackInput.label<<std::endl;
+    return;
+  }
+
+  for (unsigned int itrack = 0; itrack < trackCollectionHandle->size(); ++itrack) {
+    reco::TrackRef trackref(trackCollectionHandle, itrack);
+    for (trackingRecHit_iterator ihit = trackref->recHitsBegin(); ihit != trackref->recHitsEnd(); ++ihit) {
+      const TrackingRecHit* hit = &(**ihit);
+      if (!hit->isValid() || hit->geographicalId().det() != DetId::Tracker) continue;
+      hitStudy(hit, 0, trackref, es, conditions);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------------
+// Dispatch the strip clusters of one hit (see SiStripHitVisitor.h) to clusterStudy, with the
+// track direction in the frame of their module: from the trajectory state if there is one,
+// from the helix otherwise.
+void SiStripMonitorTrack::hitStudy(const TrackingRecHit* hit, const TrajectoryStateOnSurface* tsos, reco::TrackRef trackref, const edm::EventSetup& es, const SiStripConditionsContext& conditions){
+
+  unsigned int nclusters = visitStripHit(*hit, *conditions.geometry(), [&](const SiStripHitCluster& c) {
+      LocalVector statedirection = hitDirection(c.unit, c.hitDet, tsos, *trackref, conditions);
+      if (statedirection.mag() != 0) clusterStudy(c, statedirection, trackref.key(), es, conditions);
+    });
+  if (nclusters == 0)
+    LogDebug("SiStripMonitorTrack") << " no strip cluster in hit on det " << hit->geographicalId().rawId() << std::endl;
+}
+
+//------------------------------------------------------------------------------------------
+LocalVector SiStripMonitorTrack::hitDirection(const GeomDet* det, const GeomDet* hitdet, const TrajectoryStateOnSurface* tsos, const reco::Track& track, const SiStripConditionsContext& conditions)
+{
+  if (tsos == 0) return helixDirection(track, *det, conditions);
+
+  LocalVector direction = (det == hitdet) ? tsos->localMomentum() : det->toLocal(hitdet->toGlobal(tsos->localMomentum()));
+
+  // compare with the helix estimate on the same module
+  if (HelixAngleValidation_ && direction.mag() != 0) {
+    LocalVector helix = helixDirection(track, *det, conditions);
+    if (helix.mag() != 0) {
+      SubDetFills* subdet_mes = moduleMEs(det->geographicalId().rawId(), currentInput_).subdet;
+      if (subdet_mes)
+	queueME(subdet_mes->DeltaCosRZHelixOnTrack, fabs(helix.z())/helix.mag() - fabs(direction.z())/direction.mag());
+    }
+  }
+  return direction;
+}
+
+//------------------------------------------------------------------------------------------
+// Cheap helix extrapolation of the track to the plane of det: starts from the innermost
+// measured state when the TrackExtra is available (reference point otherwise), uses the
+// field value at the starting point and ignores material effects.
+LocalVector SiStripMonitorTrack::helixDirection(const reco::Track& track, const GeomDet& det, const SiStripConditionsContext& conditions) const
+{
+  GlobalPoint  position(track.vx(), track.vy(), track.vz());
+  GlobalVector momentum(track.px(), track.py(), track.pz());
+  if (track.extra().isNonnull() && track.extra().isAvailable() && track.innerOk()) {
+    position = GlobalPoint(track.innerPosition().x(), track.innerPosition().y(), track.innerPosition().z());
+    momentum = GlobalVector(track.innerMomentum().x(), track.innerMomentum().y(), track.innerMomentum().z());
+  }
+  GlobalTrajectoryParameters gtp(position, momentum, track.charge(), conditions.field());
+
+  HelixArbitraryPlaneCrossing crossing(HelixArbitraryPlaneCrossing::PositionType(position.x(), position.y(), position.z()),
+				       HelixArbitraryPlaneCrossing::DirectionType(momentum.x(), momentum.y(), momentum.z()),
+				       gtp.transverseCurvature(), anyDirection);
+  std::pair<bool,double> path = crossing.pathLength(det.surface());
+  if (!path.first) {
+    LogTrace("SiStripMonitorTrack") << "helix does not cross det " << det.geographicalId().rawId() << std::endl;
+    return LocalVector();
+  }
+  HelixArbitraryPlaneCrossing::DirectionType direction = crossing.direction(path.second);
+  return det.toLocal(GlobalVector(direction.x(), direction.y(), direction.z()));
+}
+
+//------------------------------------------------------------------------------------------
+void SiStripMonitorTrack::clusterStudy(const SiStripHitCluster& hitCluster, LocalVector LV, uint32_t track, const edm::EventSetup& es, const SiStripConditionsContext& conditions){
+    
+    const uint32_t detid = hitCluster.detid;
+    const uint32_t modIndex = hotModuleFinder_.index(detid);
+    if (hotModuleFinder_.excluded(modIndex, detid)){
+      LogTrace("SiStripMonitorTrack") << "Modules Excluded" << std::endl;
+      return;
+    }
+    
+    LogTrace("SiStripMonitorTrack")
+      <<"\n\t\tCluster on det "<<detid
+      <<"\n\t\tCluster barycenter "<<hitCluster.cluster->barycenter()
+      <<"\n\t\tRecHit trackLocal vector "<<LV.x() << " " << LV.y() << " " << LV.z() <<std::endl; 
+
+    const SiStripCluster* SiStripCluster_ = hitCluster.cluster;
+
+    // cluster already met on a track of this input
+    uint32_t row = clusterRow(SiStripCluster_);
+    if (row != invalidRow && onTrackSlot_[row] >= 0) {
+      const OnTrackCluster& first = onTrackClusters_[onTrackSlot_[row]];
+      if (!first.passed || sharedClusters_ == FillOnce) return;
+      if (sharedClusters_ == FillPerTrack) {
+	clusterInfos(first.values, detid, modIndex, OnTrack, LV);
+	return;
+      }
+      // FillShared: the other tracks on the cluster only fill the shared-cluster StoNCorr
+      if (first.track == track || LV.mag() == 0 || first.values.noise <= 0.0) return;
+      SubDetFills* subdet_mes = moduleMEs(detid, modIndex, currentInput_).subdet;
+      if (subdet_mes)
+	queueME(subdet_mes->ClusterStoNCorrSharedOnTrack, first.values.StoN*fabs(LV.z())/LV.mag());
+      return;
+    }
+
+    ClusterValues values;
+    if (clusterFeatures_ && hitCluster.ref->id() == clusterFeatures_->clusterProductID) {
+      clusterValues(*clusterFeatures_, hitCluster.ref->key(), *SiStripCluster_, values);
+    } else {
+      SiStripClusterInfo SiStripClusterInfo_(*SiStripCluster_,es,detid);
+      clusterValues(SiStripClusterInfo_, *SiStripCluster_, values);
+    }
+            
+    bool passed = clusterInfos(values,detid,modIndex, OnTrack, LV );
+    if ( passed ) {
+      markOnTrack(SiStripCluster_);
+      if (RawDigis_On_ && currentInput_ == 0) {
+	OnTrackStrips strips = { detid, SiStripCluster_->firstStrip(), uint16_t(SiStripCluster_->amplitudes().size()) };
+	vOnTrackStrips.push_back(strips);
+      }
+    }
+    if (row != invalidRow) {
+      onTrackSlot_[row] = onTrackClusters_.size();
+      OnTrackCluster seen = { row, track, passed, values };
+      onTrackClusters_.push_back(seen);
+    }
+  }
+
+//------------------------------------------------------------------------------------------
+void SiStripMonitorTrack::resetOnTrackClusters()
+{
+  for (ScratchVector<OnTrackCluster>::const_iterator it = onTrackClusters_.begin(); it != onTrackClusters_.end(); ++it)
+    onTrackSlot_[it->row] = -1;
+  onTrackClusters_.clear();
+}
+
+//------------------------------------------------------------------------
+// Virgin raw digis: per APV (128 strips) common mode (median of the pedestal
+// subtracted ADCs) and noise (RMS after common mode subtraction), and fraction of
+// the strips under the on-track clusters of the module above threshold x noise.
+// The digis are read in place, only the 128 values of the current APV are kept.
+void SiStripMonitorTrack::rawDigiStudy(const edm::Event& ev, const edm::EventSetup& es, const SiStripConditionsContext& conditions)
+{
+  edm::Handle< edm::DetSetVector<SiStripRawDigi> > rawDigiHandle;
+  ev.getByLabel(RawDigiProducer_, RawDigiLabel_, rawDigiHandle);
+  if (!rawDigiHandle.isValid()) {
+    edm::LogError("SiStripMonitorTrack") << "RawDigi collection " << RawDigiProducer_ << ":" << RawDigiLabel_ << " is not valid!!" << std::endl;
+    return;
+  }
+  edm::ESHandle<SiStripPedestals> pedestalsHandle;
+  es.get<SiStripPedestalsRcd>().get(pedestalsHandle);
+
+  std::sort(vOnTrackStrips.begin(), vOnTrackStrips.end());
+
+  const unsigned int nStripsAPV = 128;
+  float subtracted[nStripsAPV];
+  float work[nStripsAPV];
+
+  for (edm::DetSetVector<SiStripRawDigi>::const_iterator DSViter = rawDigiHandle->begin(); DSViter != rawDigiHandle->end(); ++DSViter) {
+    uint32_t detid = DSViter->id;
+    if (hotModuleFinder_.excluded(hotModuleFinder_.index(detid), detid)) continue;
+
+    LayerFills* layer = moduleMEs(detid, 0).layer;
+    if (layer == 0) continue;
+    LayerMEs& layer_mes = *layer->mes;
+
+    SiStripPedestals::Range pedRange = pedestalsHandle->getRange(detid);
+    std::pair<ScratchVector<OnTrackStrips>::const_iterator, ScratchVector<OnTrackStrips>::const_iterator> onTrack =
+      std::equal_range(vOnTrackStrips.begin(), vOnTrackStrips.end(), OnTrackStrips{ detid, 0, 0 });
+
+    const std::vector<SiStripRawDigi>& digis = DSViter->data;
+    unsigned int nAPVs = digis.size()/nStripsAPV;
+    unsigned int nOnTrack = 0, nOnTrackHit = 0;
+    for (unsigned int iapv = 0; iapv < nAPVs; ++iapv) {
+      const SiStripRawDigi* adc = &digis[iapv*nStripsAPV];
+      uint16_t firstStrip = iapv*nStripsAPV;
+
+      for (unsigned int i = 0; i < nStripsAPV; ++i)
+	subtracted[i] = adc[i].adc() - pedestalsHandle->getPed(firstStrip + i, pedRange);
+
+      // common mode: median of the APV
+      std::copy(subtracted, subtracted + nStripsAPV, work);
+      std::nth_element(work, work + nStripsAPV/2, work + nStripsAPV);
+      float commonMode = work[nStripsAPV/2];
+
+      // noise: plain reductions over the APV, vectorised by the compiler
+      float sum = 0., sum2 = 0.;
+      for (unsigned int i = 0; i < nStripsAPV; ++i) {
+	float v = subtracted[i] - commonMode;
+	subtracted[i] = v;
+	sum  += v;
+	sum2 += v*v;
+      }
+      float mean  = sum/nStripsAPV;
+      float noise = std::sqrt(std::max(0.f, sum2/nStripsAPV - mean*mean));
+
+      queueME(layer_mes.RawCommonMode, commonMode);
+      queueME(layer_mes.RawNoise, noise);
+
+      // strips of this APV under the on-track clusters
+      float threshold = RawDigiHitThreshold_*noise;
+      for (ScratchVector<OnTrackStrips>::const_iterator it = onTrack.first; it != onTrack.second; ++it) {
+	unsigned int begin = std::max<int>(it->firstStrip, firstStrip);
+	unsigned int end   = std::min<int>(it->firstStrip + it->width, firstStrip + nStripsAPV);
+	for (unsigned int strip = begin; strip < end; ++strip) {
+	  ++nOnTrack;
+	  if (subtracted[strip - firstStrip] > threshold) ++nOnTrackHit;
+	}
+      }
+    }
+    if (nOnTrack > 0) queueME(layer_mes.RawOccupancyOnTrack, float(nOnTrackHit)/nOnTrack);
+  }
+}
+
+//------------------------------------------------------------------------
+
+// Single pass over the clusters for all the track inputs: the full off-track analysis
+// for the clusters not on a primary track, and the off-track count of every other input
+// from its bit in onTrackMask_.
+void SiStripMonitorTrack::AllClusters(const edm::Handle< edmNew::DetSetVector<SiStripCluster> >& siStripClusterHandle, const edm::EventSetup& es, const SiStripConditionsContext& conditions) 
+{
+  // the shared feature table is used if it was made from this cluster collection
+  bool useFeatures = clusterFeatures_ && clusterFeatures_->clusterProductID == siStripClusterHandle.id();
+  const unsigned int nInputs = trackInputs_.size();
+  int* nOffTrack = eventArena_.allocate<int>(nInputs);
+
+  // off-track candidates of the primary input against the cluster budget of the event;
+  // when sampling, the counts come from the on-track bits and only the sampled clusters
+  // are analysed, with weight 1/fraction in the off-track distributions
+  if (clusterSampler_.on()) {
+    uint32_t nCandidates = 0;
+    for (ScratchVector<uint8_t>::const_iterator m = onTrackMask_.begin(); m != onTrackMask_.end(); ++m)
+      nCandidates += !(*m & 1);
+    fillME(SamplingFraction, clusterSampler_.beginEvent(runNb, eventNb, nCandidates));
+  }
+  bool sampling = clusterSampler_.sampling();
+
+  //Loop on Dets
+  for ( edmNew::DetSetVector<SiStripCluster>::const_iterator DSViter=siStripClusterHandle->begin(); DSViter!=siStripClusterHandle->end();DSViter++){
+    uint32_t detid=DSViter->id();
+    uint32_t modIndex = hotModuleFinder_.index(detid);
+    if (hotModuleFinder_.excluded(modIndex, detid)) continue;
+    hotModuleFinder_.count(modIndex, DSViter->size());
+    //Loop on Clusters
+    LogDebug("SiStripMonitorTrack") << "on detid "<< detid << " N Cluster= " << DSViter->size();
+    bool hot = hotModuleFinder_.hot(modIndex);
+    bool counted = hot || sampling;
+    std::fill(nOffTrack, nOffTrack + nInputs, 0);
+    for(edmNew::DetSet<SiStripCluster>::const_iterator ClusIter = DSViter->begin(); ClusIter!=DSViter->end(); ClusIter++) {
+      uint32_t row = &*ClusIter - firstCluster_;
+      uint8_t mask = onTrackMask_[row];
+      if (counted) {
+	// hot module or sampled event: count the off-track clusters from the DetSet
+	// and the on-track bits (without ClusterConditions, which would need the
+	// cluster values of every cluster), analyse only the sample
+	for (unsigned int input = 0; input < nInputs; ++input)
+	  if (!(mask & (1 << input))) ++nOffTrack[input];
+	if (hot || (mask & 1) || !clusterSampler_.selected(row)) continue;
+	ClusterValues values;
+	if (useFeatures) {
+	  clusterValues(*clusterFeatures_, row, *ClusIter, values);
+	} else {
+	  SiStripClusterInfo SiStripClusterInfo_(*ClusIter,es,detid);
+	  clusterValues(SiStripClusterInfo_, *ClusIter, values);
+	}
+	clusterInfos(values,detid,modIndex,OffTrack,LV);
+	continue;
+      }
+      if (mask == (1 << nInputs) - 1) continue;
+      ClusterValues values;
+      if (useFeatures) {
+	clusterValues(*clusterFeatures_, row, *ClusIter, values);
+      } else {
+	SiStripClusterInfo SiStripClusterInfo_(*ClusIter,es,detid);
+	clusterValues(SiStripClusterInfo_, *ClusIter, values);
+      }
+      if (!(mask & 1)) clusterInfos(values,detid,modIndex,OffTrack,LV);
+      if (nInputs > 1 && passClusterQuality(values)) {
+	for (unsigned int input = 1; input < nInputs; ++input)
+	  if (!(mask & (1 << input))) ++nOffTrack[input];
+      }
+    }
+    if (counted && TkHistoMap_On_) {
+      if (modIndex != SiStripHotModuleFinder::invalidIndex) tkhistoAccNumOffTrack_.add(modIndex,nOffTrack[0]);
+      else tkhisto_NumOffTrack->add(detid,nOffTrack[0]);
+    }
+    // otherwise the primary input is counted by clusterInfos
+    for (unsigned int input = (counted ? 0 : 1); input < nInputs; ++input) {
+      if (nOffTrack[input] == 0) continue;
+      SubDetFills* subdet_mes = moduleMEs(detid, modIndex, input).subdet;
+      if (subdet_mes) subdet_mes->totNClustersOffTrack += nOffTrack[input];
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+void SiStripMonitorTrack::clusterValues(const SiStripClusterInfo& info, const SiStripCluster& cluster, ClusterValues& values) const
+{
+  values.StoN     = info.signalOverNoise();
+  values.noise    = info.noiseRescaledByGain();
+  values.charge   = info.charge();
+  values.width    = info.width();
+  values.position = info.baryStrip();
+  values.cluster  = &cluster;
+}
+
+//------------------------------------------------------------------------
+void SiStripMonitorTrack::clusterValues(const SiStripClusterFeatures& features, unsigned int row, const SiStripCluster& cluster, ClusterValues& values) const
+{
+  values.StoN     = features.StoN[row];
+  values.noise    = features.noise[row];
+  values.charge   = features.charge[row];
+  values.width    = features.width[row];
+  values.position = features.barycenter[row];
+  values.cluster  = &cluster;
+}
+
+//------------------------------------------------------------------------
+bool SiStripMonitorTrack::passClusterQuality(const ClusterValues& cluster) const
+{
+  return !( (applyClusterQuality_) &&
+	    (cluster.StoN < sToNLowerLimit_ ||
+	     cluster.StoN > sToNUpperLimit_ ||
+	     cluster.width < widthLowerLimit_ ||
+	     cluster.width > widthUpperLimit_) );
+}
+
+//------------------------------------------------------------------------
+bool SiStripMonitorTrack::clusterInfos(const ClusterValues& cluster, const uint32_t& detid, uint32_t modIndex, enum ClusterFlags flag, const LocalVector LV)
+{
+  // if one imposes a cut on the clusters, apply it
+  if (!passClusterQuality(cluster)) return false;
+  // start of the analysis
+  
+  const ModuleMEs& module_mes = moduleMEs(detid, modIndex, currentInput_);
+  if(module_mes.subdet){ 
+    if (flag == OnTrack) module_mes.subdet->totNClustersOnTrack++;
+    else if (flag == OffTrack && !clusterSampler_.sampling()) module_mes.subdet->totNClustersOffTrack++;
+  }
+  
+  float cosRZ = -2;
+  LogDebug("SiStripMonitorTrack")<< "\n\tLV " << LV.x() << " " << LV.y() << " " << LV.z() << " " << LV.mag() << std::endl;
+  if (LV.mag()!=0){
+    cosRZ= fabs(LV.z())/LV.mag();
+    LogDebug("SiStripMonitorTrack")<< "\n\t cosRZ " << cosRZ << std::endl;
+  }
+  
+  // Filling SubDet/Layer Plots (on Track + off Track)
+  fillMEs(cluster,detid,module_mes,cosRZ,flag);
+
+  // ntuple, TkHistoMaps and module plots only for the primary track input
+  if (currentInput_ != 0) return true;
+  
+  if (ClusterNtuple_On_) {
+    SiStripClusterNtupleWriter::Record record;
+    record.detid      = detid;
+    record.flag       = (flag == OnTrack) ? 1 : 0;
+    record.StoN       = cluster.StoN;
+    record.cosRZ      = cosRZ;
+    record.charge     = cluster.charge;
+    record.width      = cluster.width;
+    record.barycenter = cluster.position;
+    record.noise      = cluster.noise;
+    record.run        = runNb;
+    record.lumi       = lumiNb;
+    record.event      = eventNb;
+    record.weight     = (flag == OnTrack) ? 1.f : clusterSampler_.weight();
+    clusterNtuple_->fill(record);
+  }
+  
+  
+  //******** TkHistoMaps, accumulated per module (directly for the modules not in the cabling)
+  if (TkHistoMap_On_) {
+    uint32_t adet=detid;
+    bool listed = modIndex != SiStripHotModuleFinder::invalidIndex;
+    float noise = cluster.noise;
+    if(flag==OnTrack){
+      if (listed) tkhistoAccNumOnTrack_.add(modIndex,1);
+      else tkhisto_NumOnTrack->add(adet,1.);
+      if(noise > 0.0) {
+	if (listed) tkhistoAccStoNCorrOnTrack_.fill(modIndex,cluster.StoN*cosRZ);
+	else tkhisto_StoNCorrOnTrack->fill(adet,cluster.StoN*cosRZ);
+      }
+      if(noise == 0.0) 
+	LogDebug("SiStripMonitorTrack") << "Module " << detid << " in Event " << eventNb << " noise " << noise << std::endl;
+    }
+    else if(flag==OffTrack){
+      if (!clusterSampler_.sampling()) {
+	if (listed) tkhistoAccNumOffTrack_.add(modIndex,1);
+	else tkhisto_NumOffTrack->add(adet,1.);
+      }
+      if(cluster.charge > 250){
+	LogDebug("SiStripMonitorTrack") << "Module firing " << detid << " in Event " << eventNb << std::endl;
+      }
+    }
+  }
+
+  // APV plots, onTrack Clusters only
+  if (APV_On_ && flag==OnTrack) {
+    if (modIndex != SiStripHotModuleFinder::invalidIndex)
+      apvAccumulator_.fill(modIndex, cluster.cluster->barycenter(), cluster.charge*cosRZ, cluster.StoN*cosRZ, cluster.noise > 0.0);
+  }
+
+  // Module plots filled only for onTrack Clusters
+  if(ModStatistics_On_){
+    if(flag==OnTrack){
+      if (modIndex != SiStripHotModuleFinder::invalidIndex) {
+	if(cluster.noise > 0.0) moduleStatistics_.fill(modIndex, SiStripModuleStatistics::StoNCorr, cluster.StoN*cosRZ);
+	moduleStatistics_.fill(modIndex, SiStripModuleStatistics::Charge,     cluster.charge);
+	moduleStatistics_.fill(modIndex, SiStripModuleStatistics::ChargeCorr, cluster.charge*cosRZ);
+	moduleStatistics_.fill(modIndex, SiStripModuleStatistics::Width,      cluster.width);
+      }
+    }
+  }
+  else if(Mod_On_){
+    if(flag==OnTrack) fillModMEs(cluster,detid,cosRZ,modIndex); 
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------------------
+void SiStripMonitorTrack::fillModMEs(const ClusterValues& cluster,uint32_t detid,float cos,uint32_t modIndex)
+{
+  const ModMEs* mod_mes = (modIndex != SiStripHotModuleFinder::invalidIndex && modFills_[modIndex].booked) ? &modFills_[modIndex].mes : 0;
+  if(mod_mes){
+
+    float    StoN     = cluster.StoN;
+    uint16_t charge   = cluster.charge;
+    uint16_t width    = cluster.width;
+    float    position = cluster.position; 
+
+    float noise = cluster.noise;
+    if(noise > 0.0) queueME(mod_mes->ClusterStoNCorr ,StoN*cos);
+    if(noise == 0.0) LogDebug("SiStripMonitorTrack") << "Module " << detid << " in Event " << eventNb << " noise " << noise << std::endl;
+    queueME(mod_mes->ClusterCharge,charge);
+
+    queueME(mod_mes->ClusterChargeCorr,charge*cos);
+
+    queueME(mod_mes->ClusterWidth ,width);
+    queueME(mod_mes->ClusterPos   ,position);
+    
+    //accumulate the PGV histo, filled in flushPGV
+    pgvAccumulator_.fill(modIndex, cluster.cluster->amplitudes());
+  }
+}
+
+//--------------------------------------------------------------------------------
+void SiStripMonitorTrack::flushTkHistoMaps()
+{
+  tkhistoAccStoNCorrOnTrack_.flush(tkhisto_StoNCorrOnTrack);
+  tkhistoAccNumOnTrack_.flush(tkhisto_NumOnTrack);
+  tkhistoAccNumOffTrack_.flush(tkhisto_NumOffTrack);
+}
+
+//--------------------------------------------------------------------------------
+void SiStripMonitorTrack::flushPGV()
+{
+  const std::vector<uint32_t>& dirty = pgvAccumulator_.dirty();
+  for (std::vector<uint32_t>::const_iterator iMod = dirty.begin(); iMod != dirty.end(); ++iMod)
+    pgvAccumulator_.flush(*iMod, modFills_[*iMod].booked ? modFills_[*iMod].mes.ClusterPGV : 0);
+  pgvAccumulator_.clearDirty();
+}
+
+//------------------------------------------------------------------------
+void SiStripMonitorTrack::fillMEs(const ClusterValues& cluster,uint32_t detid, const ModuleMEs& module_mes, float cos, enum ClusterFlags flag)
+{ 
+  float    StoN     = cluster.StoN;
+  float    noise    = cluster.noise;
+  uint16_t charge   = cluster.charge;
+  uint16_t width    = cluster.width;
+  float    position = cluster.position; 
+   
+  LayerFills* layer_mes = module_mes.layer;
+  if (layer_mes) {
+    if(flag==OnTrack){
+      if(noise > 0.0 && layerstoncorrontrack) {
+	queueME(layer_mes->ClusterStoNCorrOnTrack, StoN*cos);
+	qualityTests_.fill(SiStripQualityTests::StoNCorrMean, layer_mes->qtStoNCorr, StoN*cos);
+      }
+      if(noise == 0.0) LogDebug("SiStripMonitorTrack") << "Module " << detid << " in Event " << eventNb << " noise " << cluster.noise << std::endl;
+      if(layerchargecorr) queueME(layer_mes->ClusterChargeCorrOnTrack, charge*cos);
+      if (layercharge) queueME(layer_mes->ClusterChargeOnTrack, charge);
+      if (layernoise) queueME(layer_mes->ClusterNoiseOnTrack, noise);
+      if (layerwidth) {
+	queueME(layer_mes->ClusterWidthOnTrack, width);
+	qualityTests_.fill(SiStripQualityTests::WidthContents, layer_mes->qtWidth, width);
+      }
+      queueME(layer_mes->ClusterPosOnTrack, position);
+    } else {
+      // weight 1/fraction of the off-track sample, 1 without sampling
+      float weight = clusterSampler_.weight();
+      if (layercharge) queueME(layer_mes->ClusterChargeOffTrack, charge, weight);
+      if (layernoise) queueME(layer_mes->ClusterNoiseOffTrack, noise, weight);
+      if (layerwidth) queueME(layer_mes->ClusterWidthOffTrack, width, weight);
+      queueME(layer_mes->ClusterPosOffTrack, position, weight);
+    }
+  }
+  SubDetFills* subdet_mes = module_mes.subdet;
+  if(subdet_mes){
+    if(flag==OnTrack){
+      if(noise > 0.0) {
+	queueME(subdet_mes->ClusterStoNCorrOnTrack,StoN*cos);
+	qualityTests_.fill(SiStripQualityTests::StoNCorrMean, subdet_mes->qtStoNCorr, StoN*cos);
+      }
+    } else {
+      queueME(subdet_mes->ClusterChargeOffTrack,charge,clusterSampler_.weight());
+      if(noise > 0.0) queueME(subdet_mes->ClusterStoNOffTrack,StoN,clusterSampler_.weight());
+    }
+  }
+}
+//
+// -- Turn the trend buffers into the Trend_ MEs
+//
+void SiStripMonitorTrack::fillTrends()
+{
+  for (unsigned int input = 0; input < trackInputs_.size(); ++input) {
+    std::map<std::string, SubDetMEs>& subDetMEs = subDetMEsMap(input);
+    for (std::map<std::string, SubDetMEs>::iterator iSubDet = subDetMEs.begin();
+	 iSubDet != subDetMEs.end(); iSubDet++) {
+      iSubDet->second.TrendOnTrack.fill(iSubDet->second.nClustersTrendOnTrack, TrendSteps_);
+      iSubDet->second.TrendOffTrack.fill(iSubDet->second.nClustersTrendOffTrack, TrendSteps_);
+    }
+  }
+}
+//
+// -- Write the module statistics into their per-layer summaries
+//
+void SiStripMonitorTrack::publishModuleStatistics()
+{
+  for (uint16_t layer = 0; layer < ModuleStatisticsMEs.size(); ++layer)
+    moduleStatistics_.fill(ModuleStatisticsMEs[layer], layer);
+}
+//
+// -- Publish the list of hot modules
+//
+void SiStripMonitorTrack::publishHotModules()
+{
+  const std::vector<uint32_t>& hot = hotModuleFinder_.hotModules();
+  std::ostringstream list;
+  for (std::vector<uint32_t>::const_iterator it = hot.begin(); it != hot.end(); ++it) {
+    if (it != hot.begin()) list << ",";
+    list << *it;
+  }
+  std::string hotList = list.str();
+  if (HotModules)  HotModules->Fill(hotList);
+  if (nHotModules) nHotModules->Fill(int64_t(hot.size()));
+  // logged only when the hot set changes, not at every check
+  if (hotList == publishedHotModules_) return;
+  if (!hot.empty())
+    edm::LogInfo("SiStripMonitorTrack") << "[SiStripMonitorTrack::publishHotModules] Run " << runNb << " Event " << eventNb
+					<< ": " << hot.size() << " hot module(s), detailed processing skipped: " << hotList << std::endl;
+  else
+    edm::LogInfo("SiStripMonitorTrack") << "[SiStripMonitorTrack::publishHotModules] Run " << runNb << " Event " << eventNb
+					<< ": no hot module any more" << std::endl;
+  publishedHotModules_ = hotList;
+}
+//
+// -- Get Subdetector Tag from the Folder name
+//
+void SiStripMonitorTrack::getSubDetTag(std::string& folder_name, std::string& tag){
+
+  tag =  folder_name.substr(folder_name.find("MechanicalView")+15);
+  if (tag.find("side_") != std::string::npos) {
+    tag.replace(tag.find_last_of("/"),1,"_");
+  }
+}   
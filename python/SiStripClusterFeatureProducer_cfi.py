@@ -0,0 +1,8 @@
+import FWCore.ParameterSet.Config as cms
+
+# per-event table of cluster features shared by the SiStrip monitors:
+#   SiStripMonitorTrack.ClusterFeatures           = 'siStripClusterFeatures'
+#   sistripMonitorMuonHLT.clusterFeaturesTag      = 'siStripClusterFeatures'
+siStripClusterFeatures = cms.EDProducer("SiStripClusterFeatureProducer",
+    Cluster_src = cms.InputTag('siStripClusters')
+)
@@ -8,8 +8,18 @@ sistripMonitorMuonHLT = cms.EDAnalyzer("SiStripMonitorMuonHLT",
     printNormalize = cms.untracked.bool(False),
     monitorName = cms.untracked.string("HLT/HLTMonMuon"),
     prescaleEvt = cms.untracked.int32(-1),
+    # if > 0, CPU budget in microseconds per event: the all-clusters and track parts are
+    # prescaled (up to maxAdaptivePrescale) to keep the measured mean time within it, the L3
+    # muon part always runs; EffectivePrescale and MeanTimePerEvent are lumi MEs
+    timeBudget = cms.untracked.double(-1.),
+    maxAdaptivePrescale = cms.untracked.int32(1000),
     runOnClusters = cms.untracked.bool(True),
     clusterCollectionTag = cms.untracked.InputTag ("hltSiStripRawToClustersFacility"),
+    # if set, the all-clusters plots are filled from this SiStripClusterFeatureProducer table
+    # instead of clusterCollectionTag; the table comes from a DetSetVector, so it cannot be
+    # checked against the LazyGetter: its cluster source is logged once, it must hold the same
+    # clusters
+    clusterFeaturesTag = cms.untracked.InputTag (""),
     runOnMuonCandidates = cms.untracked.bool(True),
     l3MuonTag = cms.untracked.InputTag ("hltL3MuonCandidates"),
     runOnTracks = cms.untracked.bool(False),
@@ -0,0 +1,12 @@
+import FWCore.ParameterSet.Config as cms
+
+# On-track monitoring without TrackRefitter: the clusters are taken from
+# reco::Track::recHits and cosRZ from a helix extrapolation of the track
+from DQM.SiStripMonitorTrack.SiStripMonitorTrack_cfi import *
+SiStripMonitorTrack.TrackProducer     = 'generalTracks'
+SiStripMonitorTrack.TrackLabel        = ''
+SiStripMonitorTrack.TrajectoryInEvent = False
+SiStripMonitorTrack.Cluster_src       = 'siStripClusters'
+SiStripMonitorTrack.Mod_On            = False
+
+DQMSiStripMonitorTrack_NoRefit = cms.Sequence(SiStripMonitorTrack)
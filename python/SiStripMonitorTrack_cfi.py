@@ -6,21 +6,81 @@ SiStripMonitorTrack = cms.EDAnalyzer(
     
     TrackProducer = cms.string('generalTracks'),
     TrackLabel    = cms.string(''),
+    # False: on-track clusters from reco::Track::recHits, no TrackRefitter needed;
+    #        the local angle comes from a helix extrapolation of the track
     TrajectoryInEvent = cms.bool(True),
+    # with TrajectoryInEvent, book Summary_DeltaCosRZ_HelixMinusTrajectory_OnTrack
+    HelixAngleValidation = cms.bool(False),
+    # further track collections monitored by the same instance, the off-track pass over
+    # the clusters is shared. Each input only books on-track MEs (and the off-track count),
+    # with OnTrack_<Tag> in their names; at most 7. Example:
+    #   cms.PSet(TrackProducer = cms.string('cosmictrackfinderP5'), TrackLabel = cms.string(''),
+    #            TrajectoryInEvent = cms.bool(False), Tag = cms.string('CosmicTk'))
+    TrackInputs = cms.VPSet(),
+    # clusters on several tracks of an input (computed once, for the first track):
+    # 'FillPerTrack' fills the on-track MEs for every track, 'FillOnce' for the first track
+    # only, 'FillShared' for the first track and Summary_ClusterStoNCorr_SharedOnTrack for the others
+    SharedClusters = cms.string('FillPerTrack'),
     AlgoName      = cms.string('GenTk'),
     
     RawDigis_On     = cms.bool(False),
     RawDigiProducer = cms.string('simSiStripDigis'),
     RawDigiLabel    = cms.string('VirginRaw'),
+    RawDigiHitThreshold = cms.double(3.0),   # in units of the APV noise
     
     OutputMEsInRootFile = cms.bool(False),
     OutputFileName = cms.string('test_monitortrackparameters_rs.root'),    
     
     Cluster_src = cms.InputTag('siStripClusters'),
+    # table of SiStripClusterFeatureProducer run on Cluster_src; if set, the cluster
+    # noise, StoN, charge, width and barycenter are read from it instead of recomputed
+    ClusterFeatures = cms.InputTag(''),
     
     ModulesToBeExcluded = cms.vuint32(),
     
+    # modules above OccupancyFactor x (median occupancy of their layer) over the last
+    # CheckInterval events have their clusters counted (from the DetSet size, without the
+    # ClusterConditions cut) but not analysed in detail; ModulesToBeExcluded are left out of
+    # the medians. With a zero median (cosmics, low occupancy) any module with at least
+    # MinClusters clusters in the interval is flagged: raise MinClusters for such data
+    HotModuleDetection = cms.PSet( On              = cms.bool(False),
+                                   OccupancyFactor = cms.double(20.0),
+                                   MinClusters     = cms.uint32(100),
+                                   CheckInterval   = cms.uint32(100)
+                                   ),
+    
+    # above MaxClusters off-track clusters in an event only a deterministic sample (Seed,
+    # run, event, cluster) of MaxClusters of them is analysed, with weight 1/fraction in the
+    # off-track distributions; the off-track counts stay exact, from the DetSet sizes (not
+    # cut by ClusterConditions); per event fraction in Summary_OffTrackSamplingFraction
+    OffTrackSampling = cms.PSet( On          = cms.bool(False),
+                                 MaxClusters = cms.uint32(20000),
+                                 Seed        = cms.uint32(12345)
+                                 ),
+    
+    # data/sistrip_qualitytest_track.xml tests (MeanWithinExpected on the on-track StoNCorr
+    # summaries, ContentsXRange on the on-track width summaries) evaluated in the module from
+    # running counters; status (dqm::qstatus) and value MEs, one bin per layer/subdet, per lumi
+    # (QTestStatus_*, QTestValue_*, lumi flag) and for the run (QTestStatusRun_*, QTestValueRun_*)
+    QualityTests = cms.PSet( On         = cms.bool(False),
+                             MinEntries = cms.uint32(20),
+                             StoNCorrMean  = cms.PSet( xmin = cms.double(19.), xmax = cms.double(36.),
+                                                       error = cms.double(0.05), warning = cms.double(0.3) ),
+                             WidthContents = cms.PSet( xmin = cms.double(0.), xmax = cms.double(10.),
+                                                       error = cms.double(0.05), warning = cms.double(0.2) )
+                             ),
+    
     Mod_On        = cms.bool(False),
+    # on-track cluster count, mean ChargeCorr and StoNCorr per APV (APV of the cluster
+    # barycenter), all the modules in the single SiStrip/Summary_APV_OnTrack ME
+    APV_On        = cms.bool(False),
+    # with Mod_On: instead of the module histograms keep per module the running mean/RMS
+    # and a QuantileBins-bin sketch (median, most probable value) of StoNCorr, Charge,
+    # ChargeCorr and Width, published per lumi as one Summary_ModuleStatistics ME per layer
+    # (no module level Position and PGV in this mode)
+    ModuleStatistics = cms.PSet( On           = cms.bool(False),
+                                 QuantileBins = cms.uint32(16)
+                                 ),
     OffHisto_On   = cms.bool(True),
     Trend_On      = cms.bool(False),
     HistoFlag_On  = cms.bool(False),
@@ -102,6 +162,26 @@ SiStripMonitorTrack = cms.EDAnalyzer(
                                       xmax  = cms.double(1.1)
                                       ),
     
+    TH1RawCommonMode = cms.PSet( Nbinx = cms.int32(100),
+                                 xmin  = cms.double(-50.),
+                                 xmax  = cms.double(50.)
+                                 ),
+    
+    TH1RawNoise = cms.PSet( Nbinx = cms.int32(100),
+                            xmin  = cms.double(0.),
+                            xmax  = cms.double(10.)
+                            ),
+    
+    TH1RawOccupancy = cms.PSet( Nbinx = cms.int32(50),
+                                xmin  = cms.double(0.),
+                                xmax  = cms.double(1.)
+                                ),
+    
+    TH1DeltaCosRZ = cms.PSet( Nbinx = cms.int32(100),
+                              xmin  = cms.double(-0.1),
+                              xmax  = cms.double(0.1)
+                              ),
+    
     TProfileClusterPGV = cms.PSet( Nbinx = cms.int32(20),
                                    xmin = cms.double(-10.0),
                                    xmax = cms.double(10.0),
@@ -110,11 +190,38 @@ SiStripMonitorTrack = cms.EDAnalyzer(
                                    ymax = cms.double(1.2)
                                    ),
     
+    ClusterNtuple = cms.PSet( On               = cms.bool(False),
+                              FileName         = cms.string('SiStripMonitorTrack_ClusterNtuple.root'),
+                              TreeName         = cms.string('clusters'),
+                              CompressionLevel = cms.int32(5),
+                              BasketSize       = cms.int32(32000),
+                              AutoFlush        = cms.int32(100000)
+                              ),
+    
+    # Trend_ MEs: ring of Nbins points, one point per Steps lumi sections
+    # (UpdateMode 1) or per Steps seconds of orbit time (UpdateMode 2)
     Trending = cms.PSet( Nbins      = cms.int32(10),
                          Steps      = cms.int32(5),
                          UpdateMode = cms.int32(1)
                          ),
 
-    UseDCSFiltering = cms.bool(True)
+    UseDCSFiltering = cms.bool(True),
+
+    # DCSMode 'Event': DCS status of every event, 'Lumi': of the first event of
+    # each lumi section, 'Scaler': again only when the DcsStatus ready word changes.
+    # FastHLT: a GenericTriggerEventFlag selection made only of plain HLT path
+    # names is evaluated as bit tests on TriggerResults
+    EventFilterCache = cms.PSet( DCSMode = cms.string('Event'),
+                                 FastHLT = cms.bool(False)
+                                 ),
+
+    # 1D histogram fills of the cluster loop and per-event totals queued and done
+    # sorted by ME every BatchEvents events (or BatchMemoryMB of queued fills) and
+    # at lumi end; Aggregate adds the fills of the same value in one go
+    DeferredFills = cms.PSet( On            = cms.bool(False),
+                              Aggregate     = cms.bool(True),
+                              BatchEvents   = cms.uint32(1),
+                              BatchMemoryMB = cms.double(64.)
+                              )
     
     )
@@ -0,0 +1,82 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripApvAccumulator.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "DQMServices/Core/interface/DQMStore.h"
+#include "DQMServices/Core/interface/MonitorElement.h"
+#include "TH2F.h"
+
+namespace {
+  const char* statisticNames[SiStripApvAccumulator::nStatistics] = { "entries", "mean ChargeCorr", "mean StoNCorr" };
+}
+
+//------------------------------------------------------------------------
+void SiStripApvAccumulator::setModules(const std::vector<uint32_t>& detids, const std::vector<uint16_t>& napvs)
+{
+  detIds_ = detids;
+  napvs_  = napvs;
+  offsets_.resize(detIds_.size());
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < detIds_.size(); ++i) {
+    if (napvs_[i] == 0) napvs_[i] = 1;
+    offsets_[i] = offset;
+    offset += napvs_[i];
+  }
+  n_.resize(offset);
+  nStoN_.resize(offset);
+  sumCharge_.resize(offset);
+  sumStoN_.resize(offset);
+  reset();
+}
+
+//------------------------------------------------------------------------
+void SiStripApvAccumulator::reset()
+{
+  std::fill(n_.begin(), n_.end(), 0);
+  std::fill(nStoN_.begin(), nStoN_.end(), 0);
+  std::fill(sumCharge_.begin(), sumCharge_.end(), 0.);
+  std::fill(sumStoN_.begin(), sumStoN_.end(), 0.);
+}
+
+//------------------------------------------------------------------------
+MonitorElement* SiStripApvAccumulator::book(DQMStore* dbe, const std::string& name) const
+{
+  MonitorElement* me = dbe->book2D(name, name,
+				   detIds_.size(), -0.5, detIds_.size() - 0.5,
+				   maxApvs*nStatistics, -0.5, maxApvs*nStatistics - 0.5);
+  if (!me) return me;
+  TH2F* h = me->getTH2F();
+  for (uint32_t i = 0; i < detIds_.size(); ++i) {
+    std::ostringstream label;
+    label << detIds_[i];
+    h->GetXaxis()->SetBinLabel(i + 1, label.str().c_str());
+  }
+  for (uint16_t apv = 0; apv < maxApvs; ++apv) {
+    for (int s = 0; s < nStatistics; ++s) {
+      std::ostringstream label;
+      label << "APV" << apv << " " << statisticNames[s];
+      h->GetYaxis()->SetBinLabel(apv*nStatistics + s + 1, label.str().c_str());
+    }
+  }
+  return me;
+}
+
+//------------------------------------------------------------------------
+void SiStripApvAccumulator::fill(MonitorElement* me) const
+{
+  if (me == 0) return;
+  TH2F* h = me->getTH2F();
+  double entries = 0.;
+  for (uint32_t i = 0; i < detIds_.size(); ++i) {
+    for (uint16_t apv = 0; apv < napvs_[i] && apv < maxApvs; ++apv) {
+      uint32_t k = offsets_[i] + apv;
+      int ybin = apv*nStatistics + 1;
+      h->SetBinContent(i + 1, ybin + Entries,    n_[k]);
+      h->SetBinContent(i + 1, ybin + ChargeCorr, n_[k] > 0 ? sumCharge_[k]/n_[k] : 0.);
+      h->SetBinContent(i + 1, ybin + StoNCorr,   nStoN_[k] > 0 ? sumStoN_[k]/nStoN_[k] : 0.);
+      entries += n_[k];
+    }
+  }
+  h->SetEntries(entries);
+}
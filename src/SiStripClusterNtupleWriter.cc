@@ -0,0 +1,80 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripClusterNtupleWriter.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TTree.h"
+
+SiStripClusterNtupleWriter::SiStripClusterNtupleWriter(const edm::ParameterSet& pset):
+  fileName_(pset.getParameter<std::string>("FileName")),
+  treeName_(pset.getParameter<std::string>("TreeName")),
+  compressionLevel_(pset.getParameter<int32_t>("CompressionLevel")),
+  basketSize_(pset.getParameter<int32_t>("BasketSize")),
+  autoFlush_(pset.getParameter<int32_t>("AutoFlush")),
+  file_(0),
+  tree_(0)
+{
+}
+
+//------------------------------------------------------------------------
+SiStripClusterNtupleWriter::~SiStripClusterNtupleWriter()
+{
+  close();
+}
+
+//------------------------------------------------------------------------
+void SiStripClusterNtupleWriter::open()
+{
+  if (tree_) return;
+
+  // TFile::Open makes the file the current directory: restore the one of the
+  // framework (the DQMStore and TFileService book into it) when leaving
+  TDirectory::TContext ctx(gDirectory);
+  file_ = TFile::Open(fileName_.c_str(), "RECREATE", "SiStripMonitorTrack cluster ntuple", compressionLevel_);
+  if (!file_ || file_->IsZombie()) {
+    edm::LogError("SiStripMonitorTrack") << "[SiStripClusterNtupleWriter::open] cannot open " << fileName_ << std::endl;
+    delete file_;
+    file_ = 0;
+    return;
+  }
+
+  tree_ = new TTree(treeName_.c_str(), "SiStripMonitorTrack per-cluster quantities");
+  tree_->SetDirectory(file_);
+  // one branch per quantity: each column is compressed and read back independently
+  tree_->Branch("detid",      &record_.detid,      "detid/i",      basketSize_);
+  tree_->Branch("flag",       &record_.flag,       "flag/b",       basketSize_);
+  tree_->Branch("StoN",       &record_.StoN,       "StoN/F",       basketSize_);
+  tree_->Branch("cosRZ",      &record_.cosRZ,      "cosRZ/F",      basketSize_);
+  tree_->Branch("charge",     &record_.charge,     "charge/s",     basketSize_);
+  tree_->Branch("width",      &record_.width,      "width/s",      basketSize_);
+  tree_->Branch("barycenter", &record_.barycenter, "barycenter/F", basketSize_);
+  tree_->Branch("noise",      &record_.noise,      "noise/F",      basketSize_);
+  tree_->Branch("run",        &record_.run,        "run/i",        basketSize_);
+  tree_->Branch("lumi",       &record_.lumi,       "lumi/i",       basketSize_);
+  tree_->Branch("event",      &record_.event,      "event/i",      basketSize_);
+  tree_->Branch("weight",     &record_.weight,     "weight/F",     basketSize_);
+  // write the baskets out every autoFlush_ entries, memory usage stays flat
+  tree_->SetAutoFlush(autoFlush_);
+
+  edm::LogInfo("SiStripMonitorTrack") << "[SiStripClusterNtupleWriter::open] writing cluster ntuple " << treeName_ << " to " << fileName_ << std::endl;
+}
+
+//------------------------------------------------------------------------
+void SiStripClusterNtupleWriter::fillTree()
+{
+  if (tree_) tree_->Fill();
+}
+
+//------------------------------------------------------------------------
+void SiStripClusterNtupleWriter::close()
+{
+  if (!file_) return;
+  TDirectory::TContext ctx(gDirectory);
+  file_->cd();
+  if (tree_) tree_->Write("", TObject::kOverwrite);
+  file_->Close();
+  delete file_;   // owns and deletes the tree
+  file_ = 0;
+  tree_ = 0;
+}
@@ -0,0 +1,24 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripClusterSampler.h"
+
+SiStripClusterSampler::SiStripClusterSampler(const edm::ParameterSet& pset):
+  on_(pset.getParameter<bool>("On")),
+  maxClusters_(pset.getParameter<uint32_t>("MaxClusters")),
+  seed_(pset.getParameter<uint32_t>("Seed")),
+  fraction_(1.),
+  weight_(1.),
+  eventKey_(0),
+  threshold_(0)
+{
+}
+
+//------------------------------------------------------------------------
+double SiStripClusterSampler::beginEvent(uint32_t run, uint32_t event, uint32_t ncandidates)
+{
+  fraction_ = 1.;
+  if (on_ && ncandidates > maxClusters_) fraction_ = double(maxClusters_)/ncandidates;
+  weight_ = fraction_ > 0. ? 1./fraction_ : 0.;
+  eventKey_ = mix(mix(seed_ ^ (uint64_t(run) << 32)) ^ event);
+  // compare the 53 high bits of the hash, exactly representable in the double
+  threshold_ = uint64_t(fraction_*9007199254740992.) << 11;
+  return fraction_;
+}
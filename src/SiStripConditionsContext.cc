@@ -0,0 +1,48 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripConditionsContext.h"
+
+#include "DataFormats/TrackerCommon/interface/TrackerTopology.h"
+#include "Geometry/TrackerGeometryBuilder/interface/TrackerGeometry.h"
+#include "CalibFormats/SiStripObjects/interface/SiStripDetCabling.h"
+#include "MagneticField/Engine/interface/MagneticField.h"
+
+SiStripConditionsContext::SiStripConditionsContext(unsigned int products):
+  products_(products),
+  topology_(0),
+  geometry_(0),
+  cabling_(0),
+  field_(0),
+  nFetches_(0)
+{
+}
+
+//------------------------------------------------------------------------
+unsigned int SiStripConditionsContext::update(const edm::EventSetup& es)
+{
+  unsigned int changed = 0;
+  if ((products_ & Topology) && (topologyWatcher_.check(es) || topology_ == 0)) {
+    edm::ESHandle<TrackerTopology> handle;
+    es.get<IdealGeometryRecord>().get(handle);
+    topology_ = handle.product();
+    changed |= Topology;
+  }
+  if ((products_ & Geometry) && (geometryWatcher_.check(es) || geometry_ == 0)) {
+    edm::ESHandle<TrackerGeometry> handle;
+    es.get<TrackerDigiGeometryRecord>().get(handle);
+    geometry_ = handle.product();
+    changed |= Geometry;
+  }
+  if ((products_ & Cabling) && (cablingWatcher_.check(es) || cabling_ == 0)) {
+    edm::ESHandle<SiStripDetCabling> handle;
+    es.get<SiStripDetCablingRcd>().get(handle);
+    cabling_ = handle.product();
+    changed |= Cabling;
+  }
+  if ((products_ & Field) && (fieldWatcher_.check(es) || field_ == 0)) {
+    edm::ESHandle<MagneticField> handle;
+    es.get<IdealMagneticFieldRecord>().get(handle);
+    field_ = handle.product();
+    changed |= Field;
+  }
+  for (unsigned int bits = changed; bits; bits &= bits - 1) ++nFetches_;
+  return changed;
+}
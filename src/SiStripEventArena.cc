@@ -0,0 +1,55 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripEventArena.h"
+
+#include <algorithm>
+
+SiStripEventArena::SiStripEventArena(size_t chunkSize):
+  current_(new char[chunkSize]),
+  size_(chunkSize),
+  used_(0),
+  spilled_(0)
+{
+#ifdef EDM_ML_DEBUG
+  heapAllocations_ = 1;
+#endif
+}
+
+//------------------------------------------------------------------------
+SiStripEventArena::~SiStripEventArena()
+{
+  for (std::vector<char*>::iterator chunk = full_.begin(); chunk != full_.end(); ++chunk) delete [] *chunk;
+  delete [] current_;
+}
+
+//------------------------------------------------------------------------
+// current chunk full: keep it until reset() and continue in a new one
+void* SiStripEventArena::allocateChunk(size_t bytes, size_t align)
+{
+  full_.push_back(current_);
+  spilled_ += used_;
+  size_    = std::max(size_, bytes + align);
+  current_ = new char[size_];
+  used_    = 0;
+#ifdef EDM_ML_DEBUG
+  ++heapAllocations_;
+#endif
+  return allocate(bytes, align);
+}
+
+//------------------------------------------------------------------------
+void SiStripEventArena::reset()
+{
+  if (!full_.empty()) {
+    // one chunk large enough for this event from now on
+    size_t peak = spilled_ + used_;
+    for (std::vector<char*>::iterator chunk = full_.begin(); chunk != full_.end(); ++chunk) delete [] *chunk;
+    full_.clear();
+    delete [] current_;
+    size_    = std::max(size_, peak + peak/4);
+    current_ = new char[size_];
+#ifdef EDM_ML_DEBUG
+    ++heapAllocations_;
+#endif
+  }
+  used_    = 0;
+  spilled_ = 0;
+}
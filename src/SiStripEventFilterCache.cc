@@ -0,0 +1,103 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripEventFilterCache.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/Common/interface/TriggerNames.h"
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/Common/interface/TriggerResults.h"
+#include "DataFormats/Scalers/interface/DcsStatus.h"
+#include "CalibTracker/SiStripCommon/interface/SiStripDCSStatus.h"
+
+SiStripEventFilterCache::SiStripEventFilterCache(const edm::ParameterSet& pset, const edm::ParameterSet& conf):
+  dcsMode_(DCSEvent),
+  dcsValid_(false),
+  dcsDecision_(true),
+  dcsRun_(0),
+  dcsLumi_(0),
+  dcsWord_(invalid),
+  fastHlt_(false),
+  andOrHlt_(true),
+  errorReplyHlt_(false)
+{
+  std::string mode = pset.getParameter<std::string>("DCSMode");
+  if (mode == "Lumi") dcsMode_ = DCSLumi;
+  else if (mode == "Scaler") dcsMode_ = DCSScaler;
+  else if (mode != "Event")
+    edm::LogError("SiStripMonitorTrack") << "[SiStripEventFilterCache] unknown DCSMode " << mode << ", the DCS status is evaluated every event";
+
+  // fast path only for plain HLT path names
+  fastHlt_ = pset.getParameter<bool>("FastHLT") && conf.exists("andOr") && conf.exists("hltInputTag") &&
+    !conf.exists("dcsInputTag") && !conf.exists("gtInputTag") && !conf.exists("l1Algorithms") &&
+    !(conf.exists("hltDBKey") && !conf.getParameter<std::string>("hltDBKey").empty());
+  if (fastHlt_) {
+    hltInputTag_   = conf.getParameter<edm::InputTag>("hltInputTag");
+    hltPaths_      = conf.getParameter<std::vector<std::string> >("hltPaths");
+    andOrHlt_      = conf.getParameter<bool>("andOrHlt");
+    errorReplyHlt_ = conf.getParameter<bool>("errorReplyHlt");
+    if (hltPaths_.empty()) fastHlt_ = false;
+    for (std::vector<std::string>::const_iterator path = hltPaths_.begin(); path != hltPaths_.end(); ++path)
+      if (path->empty() || path->find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_") != std::string::npos)
+	fastHlt_ = false;
+  }
+}
+
+//------------------------------------------------------------------------
+void SiStripEventFilterCache::beginRun()
+{
+  dcsValid_ = false;
+  menuID_ = edm::ParameterSetID();
+  hltIndices_.clear();
+}
+
+//------------------------------------------------------------------------
+bool SiStripEventFilterCache::dcsStatus(SiStripDCSStatus& dcs, const edm::Event& e, const edm::EventSetup& es)
+{
+  switch (dcsMode_) {
+  case DCSLumi:
+    if (!dcsValid_ || e.id().run() != dcsRun_ || e.luminosityBlock() != dcsLumi_) {
+      dcsDecision_ = dcs.getStatus(e, es);
+      dcsRun_      = e.id().run();
+      dcsLumi_     = e.luminosityBlock();
+      dcsValid_    = true;
+    }
+    return dcsDecision_;
+  case DCSScaler: {
+    edm::Handle<DcsStatusCollection> scalers;
+    e.getByLabel("scalersRawToDigi", scalers);
+    uint32_t word = (scalers.isValid() && !scalers->empty()) ? (*scalers)[0].ready() : invalid;
+    if (!dcsValid_ || word != dcsWord_) {
+      dcsDecision_ = dcs.getStatus(e, es);
+      dcsWord_     = word;
+      dcsValid_    = true;
+    }
+    return dcsDecision_;
+  }
+  default:
+    return dcs.getStatus(e, es);
+  }
+}
+
+//------------------------------------------------------------------------
+bool SiStripEventFilterCache::acceptHlt(const edm::Event& e)
+{
+  edm::Handle<edm::TriggerResults> results;
+  e.getByLabel(hltInputTag_, results);
+  if (!results.isValid()) return errorReplyHlt_;
+
+  // new menu: path names to indices
+  if (hltIndices_.empty() || results->parameterSetID() != menuID_) {
+    const edm::TriggerNames& names = e.triggerNames(*results);
+    hltIndices_.assign(hltPaths_.size(), invalid);
+    for (uint32_t i = 0; i < hltPaths_.size(); ++i) {
+      uint32_t index = names.triggerIndex(hltPaths_[i]);
+      if (index < names.size()) hltIndices_[i] = index;
+      else edm::LogWarning("SiStripMonitorTrack") << "[SiStripEventFilterCache] HLT path " << hltPaths_[i] << " not in the menu";
+    }
+    menuID_ = results->parameterSetID();
+  }
+
+  for (std::vector<uint32_t>::const_iterator index = hltIndices_.begin(); index != hltIndices_.end(); ++index) {
+    bool accept = (*index == invalid || results->error(*index)) ? errorReplyHlt_ : results->accept(*index);
+    if (andOrHlt_ == accept) return accept;   // OR: first accept, AND: first reject
+  }
+  return !andOrHlt_;
+}
@@ -0,0 +1,79 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripFillQueue.h"
+
+#include <algorithm>
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "DQMServices/Core/interface/MonitorElement.h"
+#include "TH1.h"
+
+SiStripFillQueue::SiStripFillQueue(const edm::ParameterSet& pset):
+  on_(pset.getParameter<bool>("On")),
+  aggregate_(pset.getParameter<bool>("Aggregate")),
+  batchEvents_(std::max(1u, pset.getParameter<uint32_t>("BatchEvents"))),
+  maxRecords_(size_t(pset.getParameter<double>("BatchMemoryMB")*1048576.)/sizeof(Record)),
+  nEvents_(0)
+{
+}
+
+//------------------------------------------------------------------------
+void SiStripFillQueue::flush()
+{
+  if (!records_.empty()) {
+    std::sort(records_.begin(), records_.end());
+    const Record* record = &records_.front();
+    const Record* end    = record + records_.size();
+    unsigned int nRuns = 0;
+    while (record != end) {
+      const Record* last = record + 1;
+      if (aggregate_)
+	while (last != end && last->me == record->me && last->x == record->x) ++last;
+      fillRun(record, last);
+      record = last;
+      ++nRuns;
+    }
+    LogTrace("SiStripMonitorTrack") << "[SiStripFillQueue::flush] " << records_.size() << " fills of " << nEvents_ << " event(s) in " << nRuns << " runs" << std::endl;
+  }
+  records_.clear();
+  nEvents_ = 0;
+}
+
+//------------------------------------------------------------------------
+// the first record goes through the MonitorElement (flags it as updated), the
+// others are added to its histogram in one go
+void SiStripFillQueue::fillRun(const Record* first, const Record* last)
+{
+  MonitorElement* me = first->me;
+  double x = first->x;
+  me->Fill(x, first->w);
+  if (last - first == 1) return;
+
+  double sumw = 0., sumw2 = 0.;
+  bool unitWeights = true;
+  for (const Record* record = first + 1; record != last; ++record) {
+    sumw  += record->w;
+    sumw2 += double(record->w)*record->w;
+    unitWeights &= record->w == 1.f;
+  }
+  addFills(me->getTH1(), x, last - first - 1, sumw, sumw2, unitWeights);
+}
+
+//------------------------------------------------------------------------
+void SiStripFillQueue::addFills(TH1* h, double x, uint32_t n, double sumw, double sumw2, bool unitWeights)
+{
+  // TH1::Fill creates the sum of squared weights at the first weight other
+  // than 1; whatever the order of the weights in the run, do the same here
+  if (!unitWeights && h->GetSumw2N() == 0 && !h->TestBit(TH1::kIsNotW)) h->Sumw2();
+  int bin = h->GetXaxis()->FindBin(x);
+  h->AddBinContent(bin, sumw);
+  if (h->GetSumw2N()) h->GetSumw2()->fArray[bin] += sumw2;
+  h->SetEntries(h->GetEntries() + n);
+  if ((bin >= 1 && bin <= h->GetXaxis()->GetNbins()) || TH1::GetStatOverflows()) {
+    double stats[TH1::kNstat];
+    h->GetStats(stats);
+    stats[0] += sumw;
+    stats[1] += sumw2;
+    stats[2] += sumw*x;
+    stats[3] += sumw*x*x;
+    h->PutStats(stats);
+  }
+}
@@ -0,0 +1,94 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripHotModuleFinder.h"
+
+#include <algorithm>
+
+SiStripHotModuleFinder::SiStripHotModuleFinder(const edm::ParameterSet& pset):
+  on_(pset.getParameter<bool>("On")),
+  occupancyFactor_(pset.getParameter<double>("OccupancyFactor")),
+  minClusters_(pset.getParameter<uint32_t>("MinClusters")),
+  checkInterval_(pset.getParameter<uint32_t>("CheckInterval")),
+  nEvents_(0)
+{
+  if (checkInterval_ == 0) checkInterval_ = 1;
+}
+
+//------------------------------------------------------------------------
+void SiStripHotModuleFinder::setModules(const std::vector<uint32_t>& detids, const std::vector<uint16_t>& layers)
+{
+  detIds_ = detids;
+  layers_ = layers;
+  index_.clear();
+  index_.reserve(detIds_.size());
+  for (uint32_t i = 0; i < detIds_.size(); ++i) index_[detIds_[i]] = i;
+
+  flags_.assign(detIds_.size(), 0);
+  excludedUnlisted_.clear();
+  occupancy_.assign(detIds_.size(), 0);
+  hotModules_.clear();
+  nEvents_ = 0;
+
+  uint16_t nlayers = layers_.empty() ? 0 : *std::max_element(layers_.begin(), layers_.end()) + 1;
+  std::vector<uint32_t> nmodules(nlayers, 0);
+  for (uint32_t i = 0; i < layers_.size(); ++i) ++nmodules[layers_[i]];
+  layerOccupancy_.assign(nlayers, std::vector<uint32_t>());
+  for (uint16_t l = 0; l < nlayers; ++l) layerOccupancy_[l].reserve(nmodules[l]);
+}
+
+//------------------------------------------------------------------------
+void SiStripHotModuleFinder::exclude(const std::vector<uint32_t>& detids)
+{
+  for (std::vector<uint32_t>::const_iterator it = detids.begin(); it != detids.end(); ++it) {
+    uint32_t idx = index(*it);
+    if (idx != invalidIndex) flags_[idx] |= Excluded;
+    else excludedUnlisted_.insert(*it);
+  }
+}
+
+//------------------------------------------------------------------------
+void SiStripHotModuleFinder::reset()
+{
+  for (uint32_t i = 0; i < flags_.size(); ++i) flags_[i] &= Excluded;
+  std::fill(occupancy_.begin(), occupancy_.end(), 0);
+  hotModules_.clear();
+  nEvents_ = 0;
+}
+
+//------------------------------------------------------------------------
+bool SiStripHotModuleFinder::endEvent()
+{
+  if (!on_) return false;
+  if (++nEvents_ < checkInterval_) return false;
+  evaluate();
+  nEvents_ = 0;
+  return true;
+}
+
+//------------------------------------------------------------------------
+void SiStripHotModuleFinder::evaluate()
+{
+  // median occupancy of each layer over the last interval; the excluded modules
+  // are never counted and would pull it down
+  for (std::vector<std::vector<uint32_t> >::iterator it = layerOccupancy_.begin(); it != layerOccupancy_.end(); ++it) it->clear();
+  for (uint32_t i = 0; i < occupancy_.size(); ++i)
+    if (!(flags_[i] & Excluded)) layerOccupancy_[layers_[i]].push_back(occupancy_[i]);
+
+  std::vector<double> median(layerOccupancy_.size(), 0.);
+  for (uint32_t l = 0; l < layerOccupancy_.size(); ++l) {
+    std::vector<uint32_t>& v = layerOccupancy_[l];
+    if (v.empty()) continue;
+    std::nth_element(v.begin(), v.begin() + v.size()/2, v.end());
+    median[l] = v[v.size()/2];
+  }
+
+  hotModules_.clear();
+  for (uint32_t i = 0; i < occupancy_.size(); ++i) {
+    bool isHot = !(flags_[i] & Excluded) && occupancy_[i] >= minClusters_ && occupancy_[i] > occupancyFactor_*median[layers_[i]];
+    if (isHot) {
+      flags_[i] |= Hot;
+      hotModules_.push_back(detIds_[i]);
+    } else {
+      flags_[i] &= ~Hot;
+    }
+    occupancy_[i] = 0;
+  }
+}
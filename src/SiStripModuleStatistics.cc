@@ -0,0 +1,129 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripModuleStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "DQMServices/Core/interface/DQMStore.h"
+#include "DQMServices/Core/interface/MonitorElement.h"
+#include "TH2F.h"
+
+namespace {
+  const char* quantityNames[SiStripModuleStatistics::nQuantities] = { "StoNCorr", "Charge", "ChargeCorr", "Width" };
+  const char* statisticNames[SiStripModuleStatistics::nStatistics] = { "entries", "mean", "RMS", "median", "MPV" };
+}
+
+SiStripModuleStatistics::SiStripModuleStatistics(const edm::ParameterSet& pset):
+  on_(pset.getParameter<bool>("On")),
+  nBins_(std::max(1u, pset.getParameter<uint32_t>("QuantileBins")))
+{
+  for (int q = 0; q < nQuantities; ++q) {
+    xmin_[q] = 0.;
+    invBinWidth_[q] = 0.;
+  }
+}
+
+//------------------------------------------------------------------------
+void SiStripModuleStatistics::setRange(Quantity q, double xmin, double xmax)
+{
+  xmin_[q] = xmin;
+  invBinWidth_[q] = (xmax > xmin) ? nBins_/(xmax - xmin) : 0.;
+}
+
+//------------------------------------------------------------------------
+void SiStripModuleStatistics::setModules(const std::vector<uint32_t>& detids, const std::vector<uint16_t>& layers)
+{
+  detIds_ = detids;
+  uint16_t nlayers = layers.empty() ? 0 : *std::max_element(layers.begin(), layers.end()) + 1;
+  layerModules_.assign(nlayers, std::vector<uint32_t>());
+  for (uint32_t i = 0; i < layers.size(); ++i) layerModules_[layers[i]].push_back(i);
+  reset();
+}
+
+//------------------------------------------------------------------------
+void SiStripModuleStatistics::reset()
+{
+  uint32_t size = detIds_.size()*nQuantities;
+  n_.assign(size, 0);
+  mean_.assign(size, 0.);
+  m2_.assign(size, 0.);
+  sketch_.assign(size*nBins_, 0);
+}
+
+//------------------------------------------------------------------------
+MonitorElement* SiStripModuleStatistics::book(DQMStore* dbe, const std::string& name, uint16_t layer) const
+{
+  const std::vector<uint32_t>& modules = layerModules_[layer];
+  MonitorElement* me = dbe->book2D(name, name,
+				   modules.size(), 0.5, modules.size() + 0.5,
+				   nQuantities*nStatistics, -0.5, nQuantities*nStatistics - 0.5);
+  if (!me) return me;
+  TH2F* h = me->getTH2F();
+  for (uint32_t i = 0; i < modules.size(); ++i) {
+    std::ostringstream label;
+    label << detIds_[modules[i]];
+    h->GetXaxis()->SetBinLabel(i + 1, label.str().c_str());
+  }
+  for (int q = 0; q < nQuantities; ++q) {
+    for (int s = 0; s < nStatistics; ++s) {
+      std::string label = std::string(quantityNames[q]) + " " + statisticNames[s];
+      h->GetYaxis()->SetBinLabel(q*nStatistics + s + 1, label.c_str());
+    }
+  }
+  return me;
+}
+
+//------------------------------------------------------------------------
+void SiStripModuleStatistics::fill(MonitorElement* me, uint16_t layer) const
+{
+  if (me == 0 || layer >= layerModules_.size()) return;
+  TH2F* h = me->getTH2F();
+  const std::vector<uint32_t>& modules = layerModules_[layer];
+  double entries = 0.;
+  for (uint32_t i = 0; i < modules.size(); ++i) {
+    for (int q = 0; q < nQuantities; ++q) {
+      uint32_t k = modules[i]*nQuantities + q;
+      int ybin = q*nStatistics + 1;
+      double n = n_[k];
+      h->SetBinContent(i + 1, ybin + Entries, n);
+      h->SetBinContent(i + 1, ybin + Mean,    n > 0 ? mean_[k] : 0.);
+      h->SetBinContent(i + 1, ybin + RMS,     n > 1 ? std::sqrt(m2_[k]/n) : 0.);
+      h->SetBinContent(i + 1, ybin + Median,  n > 0 ? quantile(k, Quantity(q), 0.5) : 0.);
+      h->SetBinContent(i + 1, ybin + MPV,     n > 0 ? mostProbable(k, Quantity(q)) : 0.);
+      entries += n;
+    }
+  }
+  h->SetEntries(entries);
+}
+
+//------------------------------------------------------------------------
+// linear interpolation inside the sketch bin where the cumulative count crosses fraction*n
+double SiStripModuleStatistics::quantile(uint32_t k, Quantity q, double fraction) const
+{
+  const uint32_t* counts = &sketch_[k*nBins_];
+  double target = fraction*n_[k];
+  double cumulative = 0.;
+  double binWidth = invBinWidth_[q] > 0. ? 1./invBinWidth_[q] : 0.;
+  for (uint32_t b = 0; b < nBins_; ++b) {
+    if (counts[b] > 0 && cumulative + counts[b] >= target)
+      return xmin_[q] + (b + (target - cumulative)/counts[b])*binWidth;
+    cumulative += counts[b];
+  }
+  return xmin_[q] + nBins_*binWidth;
+}
+
+//------------------------------------------------------------------------
+// centre of the most populated sketch bin, refined with a parabola through its neighbours
+double SiStripModuleStatistics::mostProbable(uint32_t k, Quantity q) const
+{
+  const uint32_t* counts = &sketch_[k*nBins_];
+  uint32_t best = std::max_element(counts, counts + nBins_) - counts;
+  double binWidth = invBinWidth_[q] > 0. ? 1./invBinWidth_[q] : 0.;
+  double offset = 0.;
+  if (best > 0 && best + 1 < nBins_) {
+    double left = counts[best-1], centre = counts[best], right = counts[best+1];
+    double denominator = left - 2.*centre + right;
+    if (denominator < 0.) offset = 0.5*(left - right)/denominator;
+  }
+  return xmin_[q] + (best + 0.5 + offset)*binWidth;
+}
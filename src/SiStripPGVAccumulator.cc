@@ -0,0 +1,103 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripPGVAccumulator.h"
+
+#include <algorithm>
+
+#include "DQMServices/Core/interface/MonitorElement.h"
+#include "TProfile.h"
+
+SiStripPGVAccumulator::SiStripPGVAccumulator():
+  padLow_(0), padHigh_(0), ymin_(0.), ymax_(0.), low_(0), high_(1), stride_(1)
+{
+}
+
+//------------------------------------------------------------------------
+// same truncation as the int(xmin)/int(xmax) bounds of the per-strip fills
+void SiStripPGVAccumulator::setRange(double xmin, double xmax, double ymin, double ymax)
+{
+  padLow_  = int(xmin);
+  padHigh_ = int(xmax);
+  ymin_    = ymin;
+  ymax_    = ymax;
+  low_     = std::min(padLow_, 0);
+  high_    = std::max(padHigh_, low_ + 1);
+  stride_  = high_ - low_;
+  positions_.assign(nClusters_.size()*stride_, Position());
+  reset();
+}
+
+//------------------------------------------------------------------------
+void SiStripPGVAccumulator::setModules(uint32_t nmodules)
+{
+  nClusters_.assign(nmodules, 0);
+  positions_.assign(nmodules*stride_, Position());
+  reset();
+}
+
+//------------------------------------------------------------------------
+void SiStripPGVAccumulator::reset()
+{
+  Position empty = { 0., 0., 0, 0 };
+  std::fill(nClusters_.begin(), nClusters_.end(), 0);
+  std::fill(positions_.begin(), positions_.end(), empty);
+  dirty_.clear();
+}
+
+//------------------------------------------------------------------------
+// wider cluster than seen so far: new stride, the sums keep their positions
+void SiStripPGVAccumulator::grow(int high)
+{
+  uint32_t stride = high - low_;
+  Position empty = { 0., 0., 0, 0 };
+  std::vector<Position> positions(nClusters_.size()*stride, empty);
+  for (uint32_t index = 0; index < nClusters_.size(); ++index)
+    std::copy(positions_.begin() + index*stride_, positions_.begin() + (index + 1)*stride_, positions.begin() + index*stride);
+  positions_.swap(positions);
+  stride_ = stride;
+  high_   = high;
+}
+
+//------------------------------------------------------------------------
+void SiStripPGVAccumulator::flush(uint32_t index, MonitorElement* me)
+{
+  uint32_t nClusters = nClusters_[index];
+  if (nClusters == 0) return;
+  Position* positions = &positions_[index*stride_];
+
+  if (me != 0) {
+    TProfile* h = me->getTProfile();
+    // statistics before the bins are touched, TProfile::GetStats may recompute them from the bins
+    double stats[TH1::kNstat];
+    h->GetStats(stats);
+    double entries = h->GetEntries();
+    TArrayD* sumw2    = h->GetSumw2();
+    TArrayD* binSumw2 = h->GetBinSumw2();
+    int nbins = h->GetXaxis()->GetNbins();
+    bool zeros = accepted(0.);
+    for (int x = low_; x < high_; ++x) {
+      const Position& p = positions[x - low_];
+      double n = p.accepted;
+      if (zeros && x >= padLow_ && x < padHigh_) n += nClusters - p.n;
+      if (n == 0) continue;
+      int bin = h->GetXaxis()->FindBin(x);
+      h->GetArray()[bin] += p.sum;
+      sumw2->fArray[bin] += p.sum2;
+      h->SetBinEntries(bin, h->GetBinEntries(bin) + n);
+      if (binSumw2->fN) binSumw2->fArray[bin] += n;
+      entries += n;
+      if ((bin >= 1 && bin <= nbins) || TH1::GetStatOverflows()) {
+	stats[0] += n;
+	stats[1] += n;
+	stats[2] += n*x;
+	stats[3] += n*x*x;
+	stats[4] += p.sum;
+	stats[5] += p.sum2;
+      }
+    }
+    h->PutStats(stats);
+    h->SetEntries(entries);
+  }
+
+  Position empty = { 0., 0., 0, 0 };
+  std::fill(positions, positions + stride_, empty);
+  nClusters_[index] = 0;
+}
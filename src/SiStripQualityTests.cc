@@ -0,0 +1,131 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripQualityTests.h"
+
+#include "DQMServices/Core/interface/DQMStore.h"
+#include "DQMServices/Core/interface/MonitorElement.h"
+#include "DQMServices/Core/interface/DQMDefinitions.h"
+
+namespace {
+  const char* testNames[SiStripQualityTests::nTests]  = { "MeanWithinExpected_StoNCorr_OnTrack", "ContentsXRange_Width_OnTrack" };
+  const char* valueTitles[SiStripQualityTests::nTests] = { "mean", "fraction in range" };
+}
+
+SiStripQualityTests::SiStripQualityTests(const edm::ParameterSet& pset):
+  on_(pset.getParameter<bool>("On")),
+  minEntries_(pset.getParameter<uint32_t>("MinEntries"))
+{
+  const char* psetNames[nTests] = { "StoNCorrMean", "WidthContents" };
+  for (int t = 0; t < nTests; ++t) {
+    edm::ParameterSet test = pset.getParameter<edm::ParameterSet>(psetNames[t]);
+    xmin_[t]    = test.getParameter<double>("xmin");
+    xmax_[t]    = test.getParameter<double>("xmax");
+    error_[t]   = test.getParameter<double>("error");
+    warning_[t] = test.getParameter<double>("warning");
+    axisMin_[t] = -1.e30;
+    axisMax_[t] =  1.e30;
+    status_[t]    = 0;
+    value_[t]     = 0;
+    runStatus_[t] = 0;
+    runValue_[t]  = 0;
+  }
+}
+
+//------------------------------------------------------------------------
+void SiStripQualityTests::setAxisRange(Test t, double xmin, double xmax)
+{
+  axisMin_[t] = xmin;
+  axisMax_[t] = xmax;
+}
+
+//------------------------------------------------------------------------
+int SiStripQualityTests::addUnit(Test t, const std::string& name)
+{
+  Counters empty = { 0., 0. };
+  units_[t].push_back(name);
+  lumi_[t].push_back(empty);
+  run_[t].push_back(empty);
+  return units_[t].size() - 1;
+}
+
+//------------------------------------------------------------------------
+void SiStripQualityTests::book(DQMStore* dbe)
+{
+  for (int t = 0; t < nTests; ++t) {
+    if (units_[t].empty()) continue;
+    int nunits = units_[t].size();
+    if (status_[t] != 0 && status_[t]->getNbinsX() == nunits) continue;
+    // units added since the last booking (new layers after a cabling change):
+    // book again with one bin per unit, the old axis would put them in overflow;
+    // results per lumi section
+    bookResults(dbe, std::string("QTestStatus_") + testNames[t], std::string("QTestValue_") + testNames[t], t, status_[t], value_[t]);
+    status_[t]->setLumiFlag();
+    value_[t]->setLumiFlag();
+    // totals of the run
+    bookResults(dbe, std::string("QTestStatusRun_") + testNames[t], std::string("QTestValueRun_") + testNames[t], t, runStatus_[t], runValue_[t]);
+  }
+}
+
+//------------------------------------------------------------------------
+void SiStripQualityTests::bookResults(DQMStore* dbe, const std::string& statusName, const std::string& valueName, int t,
+				      MonitorElement*& status, MonitorElement*& value)
+{
+  int nunits = units_[t].size();
+  if (status) dbe->removeElement(status->getPathname(), status->getName());
+  if (value)  dbe->removeElement(value->getPathname(), value->getName());
+  status = dbe->book1D(statusName, statusName, nunits, -0.5, nunits - 0.5);
+  value  = dbe->book1D(valueName, valueName, nunits, -0.5, nunits - 0.5);
+  value->setAxisTitle(valueTitles[t], 2);
+  for (int u = 0; u < nunits; ++u) {
+    status->setBinLabel(u + 1, units_[t][u], 1);
+    value->setBinLabel(u + 1, units_[t][u], 1);
+  }
+}
+
+//------------------------------------------------------------------------
+void SiStripQualityTests::endLumi()
+{
+  for (int t = 0; t < nTests; ++t) {
+    evaluate(Test(t), lumi_[t], status_[t], value_[t]);
+    for (unsigned int u = 0; u < lumi_[t].size(); ++u) {
+      run_[t][u].n   += lumi_[t][u].n;
+      run_[t][u].sum += lumi_[t][u].sum;
+      lumi_[t][u].n   = 0.;
+      lumi_[t][u].sum = 0.;
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+void SiStripQualityTests::endRun()
+{
+  for (int t = 0; t < nTests; ++t) {
+    evaluate(Test(t), run_[t], runStatus_[t], runValue_[t]);
+    for (unsigned int u = 0; u < run_[t].size(); ++u) {
+      run_[t][u].n   = 0.;
+      run_[t][u].sum = 0.;
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+// probability as in the DQM QTests: MeanWithinExpected with useRange gives 1 if the
+// mean is in [xmin,xmax] and 0 otherwise, ContentsXRange the fraction in [xmin,xmax]
+void SiStripQualityTests::evaluate(Test t, const std::vector<Counters>& counters, MonitorElement* statusME, MonitorElement* valueME) const
+{
+  if (statusME == 0 || valueME == 0) return;
+  for (unsigned int u = 0; u < counters.size(); ++u) {
+    const Counters& c = counters[u];
+    int status = dqm::qstatus::INSUF_STAT;
+    double value = 0.;
+    if (c.n > 0.) {
+      value = c.sum/c.n;
+      if (c.n >= minEntries_) {
+	double prob = (t == StoNCorrMean) ? (value >= xmin_[t] && value <= xmax_[t]) : value;
+	if (prob < error_[t])        status = dqm::qstatus::ERROR;
+	else if (prob < warning_[t]) status = dqm::qstatus::WARNING;
+	else                         status = dqm::qstatus::STATUS_OK;
+      }
+    }
+    statusME->setBinContent(u + 1, status);
+    valueME->setBinContent(u + 1, value);
+  }
+}
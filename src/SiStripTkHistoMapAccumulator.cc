@@ -0,0 +1,125 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripTkHistoMapAccumulator.h"
+
+#include "DQM/SiStripCommon/interface/TkDetMap.h"
+#include "DQM/SiStripCommon/interface/TkHistoMap.h"
+#include "DQMServices/Core/interface/MonitorElement.h"
+#include "TProfile2D.h"
+
+SiStripTkHistoMapAccumulator::SiStripTkHistoMapAccumulator()
+{
+}
+
+//------------------------------------------------------------------------
+void SiStripTkHistoMapAccumulator::setModules(const std::vector<uint32_t>& detids, TkDetMap* tkdetmap)
+{
+  detIds_ = detids;
+  index_.clear();
+  for (uint32_t i = 0; i < detids.size(); ++i) index_[detids[i]] = i;
+  std::vector<std::atomic<uint32_t> >(detids.size()).swap(counts_);
+  for (uint32_t i = 0; i < detids.size(); ++i) counts_[i].store(0, std::memory_order_relaxed);
+
+  bins_.clear();
+  for (unsigned int slot = 0; slot < maxShards; ++slot) shards_[slot].reset();
+  overflow_.reset();
+  if (tkdetmap == 0) return;
+  bins_.resize(detids.size());
+  for (uint32_t i = 0; i < detids.size(); ++i) {
+    uint32_t detid = detids[i];
+    bins_[i].layer = tkdetmap->FindLayer(detid);
+    const TkLayerMap::XYbin& xybin = tkdetmap->getXY(detid);
+    bins_[i].ix = xybin.ix;
+    bins_[i].iy = xybin.iy;
+  }
+}
+
+//------------------------------------------------------------------------
+unsigned int SiStripTkHistoMapAccumulator::threadSlot()
+{
+  static std::atomic<unsigned int> nextSlot(0);
+  static thread_local unsigned int slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+  return slot;
+}
+
+//------------------------------------------------------------------------
+void SiStripTkHistoMapAccumulator::fill(uint32_t index, float value)
+{
+  counts_[index].fetch_add(1, std::memory_order_relaxed);
+  unsigned int slot = threadSlot();
+  if (slot < maxShards) {
+    std::unique_ptr<Shard>& shard = shards_[slot];
+    if (!shard) shard.reset(new Shard(counts_.size()));
+    shard->sums[index]  += value;
+    shard->sums2[index] += double(value)*value;
+    return;
+  }
+  std::lock_guard<std::mutex> lock(overflowMutex_);
+  if (!overflow_) overflow_.reset(new Shard(counts_.size()));
+  overflow_->sums[index]  += value;
+  overflow_->sums2[index] += double(value)*value;
+}
+
+//------------------------------------------------------------------------
+void SiStripTkHistoMapAccumulator::flush(TkHistoMap* map)
+{
+  if (map == 0) return;
+  // the shards filled so far
+  std::vector<Shard*> shards;
+  for (unsigned int slot = 0; slot < maxShards; ++slot) if (shards_[slot]) shards.push_back(shards_[slot].get());
+  if (overflow_) shards.push_back(overflow_.get());
+
+  for (uint32_t i = 0; i < counts_.size(); ++i) {
+    uint32_t n = counts_[i].exchange(0, std::memory_order_relaxed);
+    if (n == 0) continue;
+    uint32_t detid = detIds_[i];
+    if (bins_.empty()) {
+      map->add(detid, float(n));
+      continue;
+    }
+    double sum = 0., sum2 = 0.;
+    for (std::vector<Shard*>::const_iterator shard = shards.begin(); shard != shards.end(); ++shard) {
+      sum  += (*shard)->sums[i];
+      sum2 += (*shard)->sums2[i];
+      (*shard)->sums[i]  = 0.;
+      (*shard)->sums2[i] = 0.;
+    }
+    if (bins_[i].layer <= 0) continue;
+    MonitorElement* me = map->getMap(bins_[i].layer);
+    if (me == 0) continue;
+    TProfile2D* profile = me->getTProfile2D();
+    if (n == 1) {
+      profile->Fill(profile->GetXaxis()->GetBinCenter(bins_[i].ix), profile->GetYaxis()->GetBinCenter(bins_[i].iy), sum);
+      continue;
+    }
+    addToBin(profile, bins_[i].ix, bins_[i].iy, n, sum, sum2);
+  }
+}
+
+//------------------------------------------------------------------------
+void SiStripTkHistoMapAccumulator::addToBin(TProfile2D* profile, int ix, int iy, uint32_t n, double sum, double sum2)
+{
+  // n unit weight fills of sum value and sum2 squared values in the bin
+  int bin = profile->GetBin(ix, iy);
+  profile->fArray[bin] += sum;
+  TArrayD* sumw2 = profile->GetSumw2();
+  if (sumw2->fN > bin) sumw2->fArray[bin] += sum2;
+  profile->SetBinEntries(bin, profile->GetBinEntries(bin) + n);
+  TArrayD* binSumw2 = profile->GetBinSumw2();
+  if (binSumw2->fN > bin) binSumw2->fArray[bin] += n;
+  profile->SetEntries(profile->GetEntries() + n);
+
+  // statistics: sumw, sumw2, sumwx, sumwx2, sumwy, sumwy2, sumwxy, sumwz, sumwz2
+  double x = profile->GetXaxis()->GetBinCenter(ix);
+  double y = profile->GetYaxis()->GetBinCenter(iy);
+  double stats[9];
+  profile->GetStats(stats);
+  stats[0] += n;
+  stats[1] += n;
+  stats[2] += n*x;
+  stats[3] += n*x*x;
+  stats[4] += n*y;
+  stats[5] += n*y*y;
+  stats[6] += n*x*y;
+  stats[7] += sum;
+  stats[8] += sum2;
+  profile->PutStats(stats);
+}
@@ -0,0 +1,67 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripTrendBuffer.h"
+
+#include <sstream>
+
+#include "DQMServices/Core/interface/MonitorElement.h"
+#include "TProfile.h"
+
+SiStripTrendBuffer::SiStripTrendBuffer(unsigned int nslots):
+  slots_(nslots),
+  head_(0),
+  size_(0)
+{
+}
+
+//------------------------------------------------------------------------
+void SiStripTrendBuffer::reset()
+{
+  head_ = 0;
+  size_ = 0;
+}
+
+//------------------------------------------------------------------------
+void SiStripTrendBuffer::open(uint32_t key)
+{
+  if (size_ > 0) head_ = (head_ + 1) % slots_.size();
+  if (size_ < slots_.size()) ++size_;
+  Slot& slot = slots_[head_];
+  slot.key  = key;
+  slot.n    = 0.;
+  slot.sum  = 0.;
+  slot.sum2 = 0.;
+}
+
+//------------------------------------------------------------------------
+void SiStripTrendBuffer::fill(MonitorElement* me, double keyScale) const
+{
+  if (me == 0 || me->kind() != MonitorElement::DQM_KIND_TPROFILE) return;
+  TProfile* profile = me->getTProfile();
+  profile->Reset();
+
+  // stats as TProfile::Fill would have accumulated them: sumw, sumw2, sumwx, sumwx2, sumwy, sumwy2
+  double stats[6] = { 0., 0., 0., 0., 0., 0. };
+  double entries = 0.;
+  unsigned int first = (head_ + slots_.size() - size_ + 1) % slots_.size();
+  for (unsigned int i = 0; i < size_ && int(i) < profile->GetNbinsX(); ++i) {
+    const Slot& slot = slots_[(first + i) % slots_.size()];
+    int bin = i + 1;
+    double x = profile->GetXaxis()->GetBinCenter(bin);
+    profile->SetBinEntries(bin, slot.n);
+    profile->SetBinContent(bin, slot.sum);
+    (*profile->GetSumw2())[bin] = slot.sum2;
+
+    std::ostringstream label;
+    label << slot.key*keyScale;
+    profile->GetXaxis()->SetBinLabel(bin, label.str().c_str());
+
+    stats[0] += slot.n;
+    stats[1] += slot.n;
+    stats[2] += slot.n*x;
+    stats[3] += slot.n*x*x;
+    stats[4] += slot.sum;
+    stats[5] += slot.sum2;
+    entries  += slot.n;
+  }
+  profile->PutStats(stats);
+  profile->SetEntries(entries);
+}
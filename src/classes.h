@@ -0,0 +1,9 @@
+#include "DQM/SiStripMonitorTrack/interface/SiStripClusterFeatures.h"
+#include "DataFormats/Common/interface/Wrapper.h"
+
+namespace {
+  struct dictionary {
+    SiStripClusterFeatures features;
+    edm::Wrapper<SiStripClusterFeatures> wfeatures;
+  };
+}
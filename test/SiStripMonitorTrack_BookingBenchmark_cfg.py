@@ -0,0 +1,81 @@
+import FWCore.ParameterSet.Config as cms
+from FWCore.ParameterSet.VarParsing import VarParsing
+
+# Booking benchmark: SiStripMonitorTrack::book() with the module MEs on the full
+# list of active detectors of the cabling, without any event data (one event
+# per run). The first run books; the next ones only reset the MEs, unless the
+# cabling or the geometry changed. The time of each book() call is reported in
+# the SiStripMonitorTrackBooking messages:
+#   cmsRun SiStripMonitorTrack_BookingBenchmark_cfg.py 2>&1 | grep SiStripMonitorTrack::book
+# The configuration also runs on releases without that message (it uses only
+# the historical parameters of the module): there the booking time is the job
+# time with the module minus the job time without it (monitor=0), e.g.
+#   /usr/bin/time -v cmsRun SiStripMonitorTrack_BookingBenchmark_cfg.py maxEvents=1 monitor=1
+#   /usr/bin/time -v cmsRun SiStripMonitorTrack_BookingBenchmark_cfg.py maxEvents=1 monitor=0
+# and the maximum resident set size of the two jobs gives the memory of the MEs.
+# moduleStatistics=1 replaces the module histograms by ModuleStatistics.
+
+options = VarParsing('analysis')
+options.register('monitor', 1, VarParsing.multiplicity.singleton, VarParsing.varType.int, "run SiStripMonitorTrack (1) or an empty path (0)")
+options.register('moduleStatistics', 0, VarParsing.multiplicity.singleton, VarParsing.varType.int, "module statistics (1) or module histograms (0) with Mod_On")
+options.maxEvents = 5
+options.parseArguments()
+
+process = cms.Process("SiStripBookingBenchmark")
+
+process.MessageLogger = cms.Service(
+    "MessageLogger",
+    destinations = cms.untracked.vstring('cout'),
+    categories   = cms.untracked.vstring('SiStripMonitorTrackBooking'),
+    cout = cms.untracked.PSet(
+    threshold = cms.untracked.string('INFO'),
+    default   = cms.untracked.PSet(limit = cms.untracked.int32(0)),
+    SiStripMonitorTrackBooking = cms.untracked.PSet(limit = cms.untracked.int32(-1))
+    )
+    )
+
+#-------------------------------------------------
+# Magnetic Field and CMS Geometry
+#-------------------------------------------------
+process.load("Configuration.StandardSequences.MagneticField_38T_cff")
+process.load("Configuration.StandardSequences.Geometry_cff")
+
+#-------------------------------------------------
+# TkDetMap for TkHistoMap
+#-------------------------------------------------
+process.TkDetMap = cms.Service("TkDetMap")
+process.SiStripDetInfoFileReader = cms.Service("SiStripDetInfoFileReader")
+
+#-------------------------------------------------
+# Calibration (cabling)
+#-------------------------------------------------
+process.load("Configuration.StandardSequences.FrontierConditions_GlobalTag_cff")
+process.GlobalTag.globaltag = "CRAFT_30X::All"
+process.es_prefer_GlobalTag = cms.ESPrefer('PoolDBESSource','GlobalTag')
+
+#-------------------------------------------------
+# DQM
+#-------------------------------------------------
+process.DQMStore = cms.Service("DQMStore",
+                               referenceFileName = cms.untracked.string(''),
+                               verbose = cms.untracked.int32(0)
+                               )
+process.load("DQM.SiStripMonitorTrack.SiStripMonitorTrack_cfi")
+process.SiStripMonitorTrack.Mod_On              = True
+process.SiStripMonitorTrack.TkHistoMap_On       = True
+process.SiStripMonitorTrack.OutputMEsInRootFile = False
+process.SiStripMonitorTrack.UseDCSFiltering     = False
+if options.moduleStatistics:
+    process.SiStripMonitorTrack.ModuleStatistics.On = True
+
+#-------------------------------------------------
+# In-/Output
+#-------------------------------------------------
+process.source = cms.Source("EmptySource",
+                            firstRun = cms.untracked.uint32(100000),
+                            numberEventsInRun = cms.untracked.uint32(1)
+                            )
+process.maxEvents = cms.untracked.PSet(input = cms.untracked.int32(options.maxEvents))
+
+if options.monitor:
+    process.p = cms.Path(process.SiStripMonitorTrack)
@@ -0,0 +1,81 @@
+import FWCore.ParameterSet.Config as cms
+from FWCore.ParameterSet.VarParsing import VarParsing
+
+# Per-event cost of SiStripMonitorTrack on a high-multiplicity RECO sample, to
+# compare two builds (e.g. before and after the EventSetup products moved to
+# SiStripConditionsContext). The Timing service prints the mean time per event
+# of each module at the end of the job:
+#   cmsRun SiStripMonitorTrack_ConditionsBenchmark_cfg.py inputFiles=<file.root> maxEvents=500
+# Run both builds on the same files and events; the first events (booking,
+# conditions loading) are skipped with skipEvents so the per-hit path dominates.
+# Within one build, deferredFills=0/1 compares the direct and the queued ME fills
+# (DeferredFills.On), best on high-occupancy data where the cluster loop dominates;
+# batchEvents=N flushes the queue every N events instead of every event.
+# For cache misses per cluster run it under perf stat, see the "Fill blocks"
+# section of doc/SiStripMonitorTrack.doc.
+# helixValidation=1 fills Summary_DeltaCosRZ_HelixMinusTrajectory_OnTrack__<subdet>
+# (trajectory mode, HelixAngleValidation) and saves the MEs in helixAngleValidation.root.
+
+options = VarParsing('analysis')
+options.register('globalTag', 'CRAFT_30X::All', VarParsing.multiplicity.singleton, VarParsing.varType.string, "global tag")
+options.register('skipEvents', 10, VarParsing.multiplicity.singleton, VarParsing.varType.int, "events skipped before timing")
+options.register('deferredFills', 0, VarParsing.multiplicity.singleton, VarParsing.varType.int, "queue the ME fills (1) or fill directly (0)")
+options.register('batchEvents', 1, VarParsing.multiplicity.singleton, VarParsing.varType.int, "events per flush of the queued ME fills")
+options.register('helixValidation', 0, VarParsing.multiplicity.singleton, VarParsing.varType.int, "book and save the helix minus trajectory cosRZ MEs (1)")
+options.parseArguments()
+
+process = cms.Process("SiStripConditionsBenchmark")
+
+process.MessageLogger = cms.Service(
+    "MessageLogger",
+    destinations = cms.untracked.vstring('cout'),
+    cout = cms.untracked.PSet(threshold = cms.untracked.string('WARNING'))
+    )
+
+#-------------------------------------------------
+# Magnetic Field, CMS Geometry and conditions
+#-------------------------------------------------
+process.load("Configuration.StandardSequences.MagneticField_38T_cff")
+process.load("Configuration.StandardSequences.Geometry_cff")
+process.TkDetMap = cms.Service("TkDetMap")
+process.SiStripDetInfoFileReader = cms.Service("SiStripDetInfoFileReader")
+process.load("Configuration.StandardSequences.FrontierConditions_GlobalTag_cff")
+process.GlobalTag.globaltag = options.globalTag
+process.es_prefer_GlobalTag = cms.ESPrefer('PoolDBESSource','GlobalTag')
+
+#-------------------------------------------------
+# DQM
+#-------------------------------------------------
+process.DQMStore = cms.Service("DQMStore",
+                               referenceFileName = cms.untracked.string(''),
+                               verbose = cms.untracked.int32(0)
+                               )
+process.load("DQM.SiStripMonitorTrack.SiStripMonitorTrack_StandAlone_cff")
+process.SiStripMonitorTrack.OutputMEsInRootFile = False
+process.SiStripMonitorTrack.UseDCSFiltering     = False
+if options.helixValidation:
+    process.SiStripMonitorTrack.HelixAngleValidation = True
+    process.SiStripMonitorTrack.OutputMEsInRootFile  = True
+    process.SiStripMonitorTrack.OutputFileName       = 'helixAngleValidation.root'
+# absent from the releases before the fill queue, which this configuration also runs on
+if hasattr(process.SiStripMonitorTrack, 'DeferredFills'):
+    process.SiStripMonitorTrack.DeferredFills.On    = bool(options.deferredFills)
+    process.SiStripMonitorTrack.DeferredFills.BatchEvents = options.batchEvents
+
+#-------------------------------------------------
+# Performance Checks
+#-------------------------------------------------
+process.Timing = cms.Service("Timing",
+                             summaryOnly = cms.untracked.bool(True)
+                             )
+
+#-------------------------------------------------
+# In-/Output
+#-------------------------------------------------
+process.source = cms.Source("PoolSource",
+                            fileNames  = cms.untracked.vstring(options.inputFiles),
+                            skipEvents = cms.untracked.uint32(options.skipEvents)
+                            )
+process.maxEvents = cms.untracked.PSet(input = cms.untracked.int32(options.maxEvents))
+
+process.p = cms.Path(process.DQMSiStripMonitorTrack_Real)
@@ -0,0 +1,108 @@
+#!/usr/bin/env python
+#
+# Rebuild SiStripMonitorTrack histograms from the cluster ntuple written with
+#   SiStripMonitorTrack.ClusterNtuple.On = True
+# without re-running the reconstruction. The binning is taken from
+# SiStripMonitorTrack_cfi.py and can be overridden on the command line. The
+# entries are weighted with the weight branch (1/fraction for the sampled
+# off-track clusters, see OffTrackSampling), as the module fills are.
+#
+# Examples:
+#   rebuildHistogramsFromClusterNtuple.py -i SiStripMonitorTrack_ClusterNtuple.root \
+#       -q ClusterStoNCorr --flag OnTrack --subdet TOB -o rebinned.root
+#   rebuildHistogramsFromClusterNtuple.py -i ntuple.root -q ClusterCharge --nbins 200 --xmin 0 --xmax 1000
+#   rebuildHistogramsFromClusterNtuple.py -i ntuple.root -q ClusterWidth --detid 369121381
+#
+import sys
+from optparse import OptionParser
+
+import ROOT
+from DQM.SiStripMonitorTrack.SiStripMonitorTrack_cfi import SiStripMonitorTrack
+
+# quantity -> (TTree expression, binning PSet of the module, on-track only)
+quantities = {
+    'ClusterStoNCorr'   : ('StoN*cosRZ',   'TH1ClusterStoNCorr',   True),
+    'ClusterStoNCorrMod': ('StoN*cosRZ',   'TH1ClusterStoNCorrMod',True),
+    'ClusterChargeCorr' : ('charge*cosRZ', 'TH1ClusterChargeCorr', True),
+    'ClusterStoN'       : ('StoN',         'TH1ClusterStoN',       False),
+    'ClusterCharge'     : ('charge',       'TH1ClusterCharge',     False),
+    'ClusterNoise'      : ('noise',        'TH1ClusterNoise',      False),
+    'ClusterWidth'      : ('width',        'TH1ClusterWidth',      False),
+    'ClusterPosition'   : ('barycenter',   None,                   False),
+}
+
+# same sub-detector numbering as StripSubdetector
+subdets = { 'TIB' : 3, 'TID' : 4, 'TOB' : 5, 'TEC' : 6 }
+
+parser = OptionParser()
+parser.add_option('-i', '--input',  dest='input',  help='cluster ntuple file')
+parser.add_option('-o', '--output', dest='output', default='rebuiltHistograms.root')
+parser.add_option('-t', '--tree',   dest='tree',   default=SiStripMonitorTrack.ClusterNtuple.TreeName.value())
+parser.add_option('-q', '--quantity', dest='quantity', default='ClusterStoNCorr', help=', '.join(sorted(quantities.keys())))
+parser.add_option('--flag',   dest='flag',   default=None, help='OnTrack or OffTrack')
+parser.add_option('--subdet', dest='subdet', default=None, help='TIB, TID, TOB or TEC')
+parser.add_option('--detid',  dest='detid',  default=None, type='int')
+parser.add_option('--runs',   dest='runs',   default=None, help='comma separated run list')
+parser.add_option('--cut',    dest='cut',    default=None, help='additional TTree selection')
+parser.add_option('--nbins',  dest='nbins',  default=None, type='int')
+parser.add_option('--xmin',   dest='xmin',   default=None, type='float')
+parser.add_option('--xmax',   dest='xmax',   default=None, type='float')
+(options, args) = parser.parse_args()
+
+if not options.input or options.quantity not in quantities:
+    parser.print_help()
+    sys.exit(1)
+
+expression, psetLabel, onTrackOnly = quantities[options.quantity]
+
+# binning from the module configuration, overridden by the options
+nbins, xmin, xmax = 768, 0.5, 768.5
+if psetLabel:
+    pset = getattr(SiStripMonitorTrack, psetLabel)
+    nbins, xmin, xmax = pset.Nbinx.value(), pset.xmin.value(), pset.xmax.value()
+if options.nbins is not None: nbins = options.nbins
+if options.xmin  is not None: xmin  = options.xmin
+if options.xmax  is not None: xmax  = options.xmax
+
+selection = []
+flag = options.flag
+if onTrackOnly and flag is None: flag = 'OnTrack'
+if flag is not None:   selection.append('flag==%d' % (1 if flag == 'OnTrack' else 0))
+if onTrackOnly or 'StoN' in expression: selection.append('noise>0')
+if options.subdet:     selection.append('((detid>>25)&0x7)==%d' % subdets[options.subdet])
+if options.detid:      selection.append('detid==%d' % options.detid)
+if options.runs:       selection.append('(' + '||'.join(['run==%s' % r for r in options.runs.split(',')]) + ')')
+if options.cut:        selection.append('(' + options.cut + ')')
+
+name = 'Summary_%s_%s' % (options.quantity, flag if flag else 'All')
+if options.subdet: name += '__' + options.subdet
+if options.detid:  name += '__det__%d' % options.detid
+
+input = ROOT.TFile.Open(options.input)
+tree = input.Get(options.tree)
+if not tree:
+    print 'no tree %s in %s' % (options.tree, options.input)
+    sys.exit(1)
+
+# only the branches used by the expression and the selection are read back
+tree.SetBranchStatus('*', 0)
+for branch in ['detid', 'flag', 'StoN', 'cosRZ', 'charge', 'width', 'barycenter', 'noise', 'run']:
+    if branch in expression or branch in ' '.join(selection):
+        tree.SetBranchStatus(branch, 1)
+
+# weights of the module fills; files written before the weight branch are unweighted
+weight = ''
+if tree.GetBranch('weight'):
+    tree.SetBranchStatus('weight', 1)
+    weight = 'weight'
+cut = '&&'.join(selection)
+if weight:
+    cut = weight + ('*(' + cut + ')' if cut else '')
+
+output = ROOT.TFile(options.output, 'UPDATE')
+histo = ROOT.TH1F(name, name, nbins, xmin, xmax)
+tree.Project(name, expression, cut)
+histo.Write('', ROOT.TObject.kOverwrite)
+print '%s: %d entries, mean %.3f, rms %.3f -> %s' % (name, histo.GetEntries(), histo.GetMean(), histo.GetRMS(), options.output)
+output.Close()
+input.Close()
@@ -0,0 +1,98 @@
+// Heap allocations of the per-event scratch of SiStripMonitorTrack: the
+// global operator new is replaced by a counting one and events of varying
+// size are run through a SiStripEventArena with arena vectors released as in
+// SiStripMonitorTrack::releaseEventScratch. After the largest event no heap
+// allocation must be seen, for any event up to that size. Only the arena
+// tables are covered, not the rest of analyze.
+
+#include "DQM/SiStripMonitorTrack/interface/SiStripEventArena.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <stdint.h>
+
+static uint64_t nNew = 0;
+
+void* operator new(size_t bytes)
+{
+  ++nNew;
+  void* p = std::malloc(bytes ? bytes : 1);
+  if (p == 0) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t bytes) { return operator new(bytes); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+template <class T> using ScratchVector = std::vector<T, SiStripArenaAllocator<T> >;
+
+struct OnTrackCluster {
+  uint32_t row;
+  uint32_t track;
+  bool     passed;
+  float    values[6];
+};
+
+// one event of nClusters clusters, filled the way analyze fills its tables
+static void runEvent(SiStripEventArena& arena, ScratchVector<uint8_t>& mask, ScratchVector<int32_t>& slot,
+		     ScratchVector<OnTrackCluster>& onTrack, uint32_t nClusters)
+{
+  mask.assign(nClusters, 0);
+  slot.assign(nClusters, -1);
+  for (uint32_t row = 0; row < nClusters; row += 3) {
+    OnTrackCluster cluster = { row, row/7, true, { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f } };
+    slot[row] = onTrack.size();
+    onTrack.push_back(cluster);
+    mask[row] |= 1;
+  }
+  int* nOffTrack = arena.allocate<int>(4);
+  nOffTrack[0] = nClusters - onTrack.size();
+
+  // releaseEventScratch
+  ScratchVector<uint8_t>(SiStripArenaAllocator<uint8_t>(arena)).swap(mask);
+  ScratchVector<int32_t>(SiStripArenaAllocator<int32_t>(arena)).swap(slot);
+  ScratchVector<OnTrackCluster>(SiStripArenaAllocator<OnTrackCluster>(arena)).swap(onTrack);
+  arena.reset();
+}
+
+int main()
+{
+  SiStripEventArena arena(1 << 16);
+  ScratchVector<uint8_t> mask((SiStripArenaAllocator<uint8_t>(arena)));
+  ScratchVector<int32_t> slot((SiStripArenaAllocator<int32_t>(arena)));
+  ScratchVector<OnTrackCluster> onTrack((SiStripArenaAllocator<OnTrackCluster>(arena)));
+
+  const uint32_t maxClusters = 200000;
+  int failures = 0;
+
+  // the first large event sizes the arena
+  uint64_t before = nNew;
+  runEvent(arena, mask, slot, onTrack, maxClusters);
+  std::printf("largest event: %llu heap allocations\n", (unsigned long long)(nNew - before));
+
+  // pseudo-random multiplicities up to the largest one
+  before = nNew;
+  uint32_t state = 12345;
+  for (int event = 0; event < 1000; ++event) {
+    state = state*1664525u + 1013904223u;
+    runEvent(arena, mask, slot, onTrack, state % (maxClusters + 1));
+  }
+  uint64_t steady = nNew - before;
+  std::printf("1000 events after it: %llu heap allocations\n", (unsigned long long)steady);
+  if (steady != 0) ++failures;
+
+  // a larger event grows the arena once, the next ones allocate nothing again
+  runEvent(arena, mask, slot, onTrack, 2*maxClusters);
+  before = nNew;
+  for (int event = 0; event < 100; ++event) runEvent(arena, mask, slot, onTrack, 2*maxClusters - event);
+  uint64_t regrown = nNew - before;
+  std::printf("100 events after a larger one: %llu heap allocations\n", (unsigned long long)regrown);
+  if (regrown != 0) ++failures;
+
+  std::printf("%s\n", failures ? "FAILED" : "OK");
+  return failures;
+}
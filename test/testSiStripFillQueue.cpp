@@ -0,0 +1,87 @@
+// Aggregated fills of SiStripFillQueue against direct TH1::Fill: for runs of
+// fills with the same value (unit weights, sampling weights above 1, weights
+// below 1 after unit ones, under- and overflow) the first fill of the run is
+// done with TH1::Fill and the others with SiStripFillQueue::addFills, as in
+// SiStripFillQueue::fillRun. Bin contents, bin errors, entries, mean and RMS
+// must match the histogram filled directly.
+
+#include "DQM/SiStripMonitorTrack/interface/SiStripFillQueue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "TH1F.h"
+
+static bool same(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-5*std::max(1., std::max(std::fabs(a), std::fabs(b)));
+}
+
+// fills (x, w) of one run: directly, and as fillRun does
+static int compare(const char* name, double x, const std::vector<float>& weights)
+{
+  TH1F direct("direct", "direct", 20, 0., 20.);
+  TH1F aggregated("aggregated", "aggregated", 20, 0., 20.);
+  // some earlier content in both
+  for (int i = 0; i < 20; ++i) {
+    direct.Fill(i + 0.5);
+    aggregated.Fill(i + 0.5);
+  }
+
+  for (unsigned int i = 0; i < weights.size(); ++i) direct.Fill(x, weights[i]);
+
+  aggregated.Fill(x, weights[0]);
+  double sumw = 0., sumw2 = 0.;
+  bool unitWeights = true;
+  for (unsigned int i = 1; i < weights.size(); ++i) {
+    sumw  += weights[i];
+    sumw2 += double(weights[i])*weights[i];
+    unitWeights &= weights[i] == 1.f;
+  }
+  SiStripFillQueue::addFills(&aggregated, x, weights.size() - 1, sumw, sumw2, unitWeights);
+
+  int failures = 0;
+  for (int bin = 0; bin <= direct.GetNbinsX() + 1; ++bin) {
+    if (!same(direct.GetBinContent(bin), aggregated.GetBinContent(bin)) ||
+	!same(direct.GetBinError(bin), aggregated.GetBinError(bin))) {
+      std::printf("%s: bin %d content %g/%g error %g/%g\n", name, bin, direct.GetBinContent(bin), aggregated.GetBinContent(bin),
+		  direct.GetBinError(bin), aggregated.GetBinError(bin));
+      ++failures;
+    }
+  }
+  if (!same(direct.GetEntries(), aggregated.GetEntries()) ||
+      !same(direct.GetMean(), aggregated.GetMean()) ||
+      !same(direct.GetRMS(), aggregated.GetRMS())) {
+    std::printf("%s: entries %g/%g mean %g/%g rms %g/%g\n", name, direct.GetEntries(), aggregated.GetEntries(),
+		direct.GetMean(), aggregated.GetMean(), direct.GetRMS(), aggregated.GetRMS());
+    ++failures;
+  }
+  std::printf("%-22s %s\n", name, failures ? "FAILED" : "OK");
+  return failures;
+}
+
+int main()
+{
+  TH1::AddDirectory(false);
+  int failures = 0;
+
+  std::vector<float> unit(50, 1.f);
+  failures += compare("unit weights", 3.5, unit);
+
+  // sampled off-track fills: weight 1/fraction, sorted first in the run
+  std::vector<float> sampled(10, 4.f);
+  sampled.insert(sampled.end(), 5, 1.f);
+  failures += compare("weights above 1", 7.5, sampled);
+
+  // weights below 1 sort after the unit ones: the first fill does not create Sumw2
+  std::vector<float> small(5, 1.f);
+  small.insert(small.end(), 10, 0.25f);
+  failures += compare("weights below 1", 12.5, small);
+
+  failures += compare("underflow", -3., unit);
+  failures += compare("overflow", 25., sampled);
+
+  return failures;
+}
@@ -0,0 +1,99 @@
+// Per-module profile sums of SiStripTkHistoMapAccumulator against direct
+// TProfile2D::Fill: n values in one bin are filled one by one in a profile and
+// added at once with SiStripTkHistoMapAccumulator::addToBin (sum and sum of
+// squares in double, as flush adds them up from the thread shards) in another,
+// with and without Sumw2 and on top of earlier content. Bin contents, bin
+// errors, bin entries, entries, means and RMS must match the profile filled
+// directly.
+
+#include "DQM/SiStripMonitorTrack/interface/SiStripTkHistoMapAccumulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "TProfile2D.h"
+
+static bool same(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-9*std::max(1., std::max(std::fabs(a), std::fabs(b)));
+}
+
+// values of one module in bin (ix, iy): directly, and as flush does
+static int compare(const char* name, int ix, int iy, const std::vector<float>& values, bool sumw2)
+{
+  TProfile2D direct("direct", "direct", 10, 0., 10., 8, 0., 8.);
+  TProfile2D summed("summed", "summed", 10, 0., 10., 8, 0., 8.);
+  if (sumw2) {
+    direct.Sumw2();
+    summed.Sumw2();
+  }
+  // some earlier content in both, the bin of the module included
+  for (int i = 0; i < 10; ++i) {
+    direct.Fill(i + 0.5, (i % 8) + 0.5, 2.*i);
+    summed.Fill(i + 0.5, (i % 8) + 0.5, 2.*i);
+  }
+
+  double x = direct.GetXaxis()->GetBinCenter(ix);
+  double y = direct.GetYaxis()->GetBinCenter(iy);
+  double sum = 0., sum2 = 0.;
+  for (unsigned int i = 0; i < values.size(); ++i) {
+    direct.Fill(x, y, values[i]);
+    sum  += values[i];
+    sum2 += double(values[i])*values[i];
+  }
+  SiStripTkHistoMapAccumulator::addToBin(&summed, ix, iy, values.size(), sum, sum2);
+
+  int failures = 0;
+  for (int jx = 0; jx <= direct.GetNbinsX() + 1; ++jx) {
+    for (int jy = 0; jy <= direct.GetNbinsY() + 1; ++jy) {
+      int bin = direct.GetBin(jx, jy);
+      if (!same(direct.GetBinContent(bin), summed.GetBinContent(bin)) ||
+	  !same(direct.GetBinError(bin), summed.GetBinError(bin)) ||
+	  !same(direct.GetBinEntries(bin), summed.GetBinEntries(bin))) {
+	std::printf("%s: bin (%d,%d) content %g/%g error %g/%g entries %g/%g\n", name, jx, jy,
+		    direct.GetBinContent(bin), summed.GetBinContent(bin), direct.GetBinError(bin), summed.GetBinError(bin),
+		    direct.GetBinEntries(bin), summed.GetBinEntries(bin));
+	++failures;
+      }
+    }
+  }
+  for (int axis = 1; axis <= 3; ++axis) {
+    if (!same(direct.GetMean(axis), summed.GetMean(axis)) || !same(direct.GetRMS(axis), summed.GetRMS(axis))) {
+      std::printf("%s: axis %d mean %g/%g rms %g/%g\n", name, axis, direct.GetMean(axis), summed.GetMean(axis),
+		  direct.GetRMS(axis), summed.GetRMS(axis));
+      ++failures;
+    }
+  }
+  if (!same(direct.GetEntries(), summed.GetEntries())) {
+    std::printf("%s: entries %g/%g\n", name, direct.GetEntries(), summed.GetEntries());
+    ++failures;
+  }
+  std::printf("%-22s %s\n", name, failures ? "FAILED" : "OK");
+  return failures;
+}
+
+int main()
+{
+  TH1::AddDirectory(false);
+  int failures = 0;
+
+  // StoN-like values, not multiples of any fixed point step
+  std::vector<float> values;
+  uint32_t state = 12345;
+  for (int i = 0; i < 200; ++i) {
+    state = state*1664525u + 1013904223u;
+    values.push_back(5.f + 40.f*(state >> 8)/float(1 << 24));
+  }
+  failures += compare("values", 4, 4, values, false);
+  failures += compare("values with Sumw2", 4, 4, values, true);
+
+  std::vector<float> two(values.begin(), values.begin() + 2);
+  failures += compare("two values", 7, 2, two, false);
+
+  // a bin without earlier content
+  failures += compare("empty bin", 9, 7, values, false);
+
+  return failures;
+}